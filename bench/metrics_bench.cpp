@@ -0,0 +1,109 @@
+// Cost of one MetricsCollector::sample() as sources are added, with network and TCP collected through the
+// shared PDH query (batched) or through the IP Helper calls (serial): wall time, kernel time and system calls.
+//
+// Windows has no per-thread system call counter, so the count is the system-wide \System\System Calls delta
+// minus an idle baseline over the same wall time. Run it on a quiet machine.
+#include "metrics.hpp"
+
+#include <cstdio>
+#include <pdh.h>
+#include <windows.h>
+
+namespace {
+const int SAMPLES = 200;
+
+struct Cost {
+    double wallUs   = 0.0; // per sample
+    double kernelUs = 0.0;
+    double syscalls = 0.0;
+};
+
+struct Config {
+    const char* sources;
+    bool        tcpDetail;
+    bool        irqMatrix;
+};
+
+PDH_HQUERY   g_callQuery   = nullptr;
+PDH_HCOUNTER g_callCounter = nullptr;
+
+// Cumulative system-wide system call count
+long long systemCalls() {
+    PDH_RAW_COUNTER raw{};
+    if (!g_callCounter || PdhCollectQueryData(g_callQuery) != ERROR_SUCCESS ||
+        PdhGetRawCounterValue(g_callCounter, nullptr, &raw) != ERROR_SUCCESS)
+        return 0;
+    return raw.FirstValue;
+}
+
+double seconds(const LARGE_INTEGER& from, const LARGE_INTEGER& to) {
+    LARGE_INTEGER freq;
+    QueryPerformanceFrequency(&freq);
+    return (double) (to.QuadPart - from.QuadPart) / (double) freq.QuadPart;
+}
+
+unsigned long long threadKernelTime() {
+    FILETIME create, exit, kernel, user;
+    GetThreadTimes(GetCurrentThread(), &create, &exit, &kernel, &user);
+    return ((unsigned long long) kernel.dwHighDateTime << 32) | kernel.dwLowDateTime;
+}
+
+double idleCallsPerSec() {
+    LARGE_INTEGER t0, t1;
+    long long     calls0 = systemCalls();
+    QueryPerformanceCounter(&t0);
+    Sleep(1000);
+    QueryPerformanceCounter(&t1);
+    return (double) (systemCalls() - calls0) / seconds(t0, t1);
+}
+
+Cost measure(const Config& config, bool serial, double idleRate) {
+    MetricsCollector m;
+    m.setSerialNetTcp(serial);
+    m.initialize();
+    m.setTcpDetailEnabled(config.tcpDetail);
+    m.setIrqMatrixEnabled(config.irqMatrix);
+    for (int i = 0; i < 3; ++i)
+        m.sample(); // grow the reused buffers and build the instance layouts
+
+    LARGE_INTEGER      t0, t1;
+    unsigned long long kernel0 = threadKernelTime();
+    long long          calls0  = systemCalls();
+    QueryPerformanceCounter(&t0);
+    for (int i = 0; i < SAMPLES; ++i)
+        m.sample();
+    QueryPerformanceCounter(&t1);
+    long long calls1 = systemCalls();
+
+    double elapsed = seconds(t0, t1);
+    Cost   cost;
+    cost.wallUs   = elapsed * 1e6 / SAMPLES;
+    cost.kernelUs = (double) (threadKernelTime() - kernel0) / 10.0 / SAMPLES;
+    cost.syscalls = ((double) (calls1 - calls0) - idleRate * elapsed) / SAMPLES;
+    return cost;
+}
+} // namespace
+
+int main() {
+    if (PdhOpenQuery(nullptr, 0, &g_callQuery) == ERROR_SUCCESS)
+        PdhAddEnglishCounterW(g_callQuery, L"\\System\\System Calls/sec", 0, &g_callCounter);
+    double idleRate = idleCallsPerSec();
+
+    // Each row adds a source on top of the previous one (plus NUMA on multi-node machines)
+    const Config configs[] = {
+        {"cpu mem net disk tcp csw", false, false},
+        {"+ tcp socket tables", true, false},
+        {"+ irq matrix", true, true},
+    };
+    std::printf("%-26s %-8s %10s %10s %10s\n", "sources", "path", "wall us", "kernel us", "syscalls");
+    for (const Config& config : configs) {
+        for (bool serial : {true, false}) {
+            Cost cost = measure(config, serial, idleRate);
+            std::printf("%-26s %-8s %10.1f %10.1f %10.0f\n", config.sources, serial ? "serial" : "batched", cost.wallUs,
+                        cost.kernelUs, cost.syscalls);
+        }
+    }
+    if (g_callQuery)
+        PdhCloseQuery(g_callQuery);
+    return 0;
+}
@@ -0,0 +1,81 @@
+#pragma once
+#include <optional>
+#include <vector>
+
+struct ThreadSample {
+    unsigned long      tid                   = 0;
+    float              cpu                   = 0.0f; // share of one core over the last interval, 0..1, from cycles
+    unsigned long long cyclesPerSec          = 0;    // precise even when the interval is shorter than a scheduler tick
+    unsigned long      contextSwitches       = 0;    // total since thread start, as of the last rescan
+    float              contextSwitchesPerSec = 0.0f; // over the last rescan interval
+};
+
+struct AttachSample {
+    unsigned long             pid                   = 0;
+    float                     cpu                   = 0.0f; // sum over threads, in cores
+    unsigned long long        workingSetBytes       = 0;
+    double                    readBytesPerSec       = 0.0;
+    double                    writeBytesPerSec      = 0.0;
+    double                    contextSwitchesPerSec = 0.0; // sum over threads, at rescan granularity
+    std::vector<ThreadSample> threads;                     // sorted by tid
+};
+
+// High-rate sampler for one process and its threads. Thread handles stay open across samples; the thread
+// list is rescanned at most every rescanIntervalMs and merged into the open set, so a tick only touches
+// threads that are already known, with one syscall each. The rescan also reads per-thread context switch
+// counts, so those update at the rescan interval rather than every tick, and it retires exited threads.
+// Steady-state sampling and rescanning do not allocate.
+class ProcessAttach {
+  public:
+    ProcessAttach() = default;
+    ~ProcessAttach();
+    ProcessAttach(const ProcessAttach&)            = delete;
+    ProcessAttach& operator=(const ProcessAttach&) = delete;
+
+    bool attach(unsigned long pid);
+    void detach();
+    bool attached() const {
+        return process_ != nullptr;
+    }
+    unsigned long pid() const {
+        return pid_;
+    }
+    void setRescanInterval(unsigned rescanIntervalMs) {
+        rescanIntervalMs_ = rescanIntervalMs;
+    }
+
+    // Fills out (reusing its capacity); returns false once the process has exited.
+    bool sample(AttachSample& out);
+
+  private:
+    struct ThreadState {
+        unsigned long      tid        = 0;
+        void*              handle     = nullptr; // HANDLE
+        unsigned long long prevTime   = 0;       // kernel + user, 100ns units (cycle-rate calibration only)
+        unsigned long long prevCycles = 0;
+        unsigned long      switches   = 0; // context switches as of the last rescan
+        float              switchRate = 0.0f;
+        bool               primed     = false;
+    };
+
+    void*                      process_          = nullptr; // HANDLE
+    unsigned long              pid_              = 0;
+    unsigned                   rescanIntervalMs_ = 1000;
+    unsigned long long         lastRescanTick_   = 0;
+    long long                  prevQpc_          = 0;
+    unsigned long long         prevReadBytes_    = 0;
+    unsigned long long         prevWriteBytes_   = 0;
+    long long                  baseQpc_          = 0;   // calibration start
+    unsigned long long         baseCycles_       = 0;
+    unsigned long long         calibCycles_      = 0;   // cycles and 100ns CPU time summed over all threads
+    unsigned long long         calibTime_        = 0;
+    double                     cyclesPerSec_     = 0.0; // cycle counter rate; 0 until calibrated
+    std::vector<ThreadState>   threads_;                // sorted by tid
+    std::vector<ThreadState>   scratchThreads_;         // reused by rescanThreads(); tid and switches only
+    std::vector<ThreadState>   mergeBuf_;               // rescanThreads() builds the new list here, then swaps
+    std::vector<unsigned char> sysInfoBuf_;             // NtQuerySystemInformation output, grown as needed
+
+    void        rescanThreads();
+    const void* findProcessInfo(); // SYSTEM_PROCESS_INFORMATION for pid_, or nullptr
+    void        closeThread(ThreadState& t);
+};
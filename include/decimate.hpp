@@ -0,0 +1,61 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+// Read-only view of a ring buffer in logical order (oldest..newest) without copying.
+// The valid samples occupy at most two contiguous spans: [head, end) then [0, head).
+struct RingView {
+    const float* first     = nullptr;
+    size_t       firstLen  = 0;
+    const float* second    = nullptr;
+    size_t       secondLen = 0;
+
+    size_t size() const {
+        return firstLen + secondLen;
+    }
+    float operator[](size_t i) const {
+        return i < firstLen ? first[i] : second[i - firstLen];
+    }
+};
+
+// nextIndex is the slot to be written next, filled the number of valid samples.
+RingView makeRingView(const std::vector<float>& buf, size_t nextIndex, size_t filled);
+
+struct EnvelopeColumn {
+    float min = 0.0f;
+    float max = 0.0f;
+};
+
+struct DecimatedPoint {
+    float x = 0.0f; // logical sample index, 0 = oldest
+    float y = 0.0f;
+};
+
+// Reduces the view to at most `columns` buckets, keeping the extremes of each so spikes survive.
+// Returns the number of columns written (less than `columns` when there are fewer samples).
+// With columns = 1 it gives the range of the whole view (the overlay scales derived graphs with it).
+int decimateMinMax(const RingView& view, EnvelopeColumn* out, int columns);
+
+// Largest-triangle-three-buckets: keeps the first and last sample plus the point of each bucket
+// that forms the largest triangle with its neighbours. Returns the number of points written.
+int decimateLttb(const RingView& view, DecimatedPoint* out, int threshold);
+
+// Incrementally maintained min/max envelope. Buckets are aligned to the absolute sample count,
+// so a new sample only touches the newest column and drawing needs no pass over the history.
+class MinMaxEnvelope {
+  public:
+    void reset(int columns, int samplesPerColumn);
+    void push(float v);
+
+    // Copies columns oldest..newest into out; returns the count written.
+    int read(EnvelopeColumn* out, int maxColumns) const;
+
+    int columns() const {
+        return (int) cols_.size();
+    }
+
+  private:
+    std::vector<EnvelopeColumn> cols_;
+    int                         samplesPerColumn_ = 1;
+    unsigned long long          pushed_           = 0;
+};
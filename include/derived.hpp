@@ -0,0 +1,55 @@
+#pragma once
+#include <string>
+#include <vector>
+
+// User-defined metrics computed from snapshot inputs, e.g.
+//     io_size = (disk_read + disk_write) / max(disk_iops, 1)
+//     cached  = mem_cache / mem_total
+//     cpu_avg = ewma(cpu, 0.2)
+// Grammar: + - * / unary -, parentheses, numbers, input or earlier metric names, and the functions
+// min(a, b), max(a, b), clamp(x, lo, hi), abs(x), rate(x) (per-second change) and ewma(x, alpha).
+// Division by zero yields 0.
+//
+// Every expression is compiled once into a single flat stack-machine program; evaluate() runs it over a
+// preallocated register file and never allocates.
+class DerivedMetrics {
+  public:
+    explicit DerivedMetrics(std::vector<std::string> inputs);
+
+    // Compiles and appends a metric; it may reference inputs and metrics added before it.
+    // On failure nothing is added and error (if given) describes the problem.
+    bool add(const std::string& name, const std::string& expression, std::string* error = nullptr);
+    void clear();
+
+    size_t count() const {
+        return names_.size() - inputCount_;
+    }
+    const std::string& name(size_t metric) const {
+        return names_[inputCount_ + metric];
+    }
+    int  find(const std::string& name) const; // metric index or -1
+    bool usesInput(size_t input) const;       // true if any compiled metric reads this input
+
+    // inputs holds one value per declared input, in declaration order.
+    void   evaluate(const double* inputs, double dtSeconds);
+    double value(size_t metric) const {
+        return regs_[inputCount_ + metric];
+    }
+
+  private:
+    enum Op : unsigned char { Const, Load, Store, Add, Sub, Mul, Div, Neg, Min, Max, Clamp, Abs, Rate, Ewma };
+    struct Instr {
+        Op       op;
+        unsigned arg = 0;   // register or state slot
+        double   k   = 0.0; // constant for Const
+    };
+    static const int MaxStack = 32;
+
+    size_t                   inputCount_ = 0;
+    std::vector<std::string> names_; // inputs followed by metrics; index = register
+    std::vector<double>      regs_;
+    std::vector<double>      state_; // rate/ewma history, NaN until first evaluation
+    std::vector<Instr>       code_;
+
+    friend class ExprCompiler;
+};
@@ -3,13 +3,17 @@
 #include <cstdint>
 #include <optional>
 #include <string>
+#include <vector>
 
 struct CpuSample {
     float usage = 0.0f; // 0..1
 };
 
 struct MemorySample {
-    float usage = 0.0f; // 0..1
+    float  usage      = 0.0f; // 0..1
+    double totalBytes = 0.0;
+    double availBytes = 0.0; // includes the standby list, so total - avail is in use excluding cache
+    double cacheBytes = 0.0; // system cache incl. standby, as Task Manager's "Cached"
 };
 
 struct NetSample {
@@ -18,9 +22,65 @@ struct NetSample {
     unsigned long linkSpeedBitsPerSec = 0; // interface nominal speed
 };
 
+// TCP connection states in MIB order (MIB_TCP_STATE_CLOSED == 1 maps to Closed).
+enum TcpState {
+    TcpClosed,
+    TcpListen,
+    TcpSynSent,
+    TcpSynRcvd,
+    TcpEstablished,
+    TcpFinWait1,
+    TcpFinWait2,
+    TcpCloseWait,
+    TcpClosing,
+    TcpLastAck,
+    TcpTimeWait,
+    TcpDeleteTcb,
+    TcpStateCount
+};
+
+// Protocol-level health, IPv4 + IPv6 combined. Rates are per second over the last interval. Fields marked
+// "detail" are only filled while MetricsCollector::setTcpDetailEnabled(true).
+struct TcpSample {
+    double retransSegsPerSec  = 0.0;
+    double outResetsPerSec    = 0.0; // segments sent with RST set (detail)
+    double estabResetsPerSec  = 0.0; // established/close-wait connections reset (a local reset also sends an RST)
+    double attemptFailsPerSec = 0.0; // failed connection attempts
+    double inErrorsPerSec     = 0.0; // segments received in error (detail)
+    double udpInErrorsPerSec  = 0.0; // UDP datagrams dropped, including receive buffer overflows
+    float  retransRatio       = 0.0f; // retransmitted / sent segments, 0..1
+
+    // Per-state socket counts (detail). Without detail only TcpEstablished is set, from the stack's own count,
+    // which also includes CLOSE_WAIT connections.
+    std::array<unsigned, TcpStateCount> socketsByState{};
+};
+
+// Per-CPU interrupt sources; the time sources are percentages of the CPU's time.
+enum IrqSource { IrqInterrupts, IrqDpcs, IrqInterruptTime, IrqDpcTime, IrqSourceCount };
+
+// CPU x source matrix, row-major: matrix[cpu * IrqSourceCount + source].
+struct IrqSample {
+    int                cpuCount              = 0;
+    std::vector<float> matrix;                      // per second, or % for the time sources
+    double             contextSwitchesPerSec = 0.0; // system-wide
+
+    float at(int cpu, int source) const {
+        return matrix[(size_t) cpu * IrqSourceCount + source];
+    }
+};
+
+struct NumaNodeSample {
+    float  cpuUsage   = 0.0f; // 0..1, mean over the node's CPUs
+    float  memUsage   = 0.0f; // 0..1, (total - available) / total
+    double totalBytes = 0.0;
+    double availBytes = 0.0;
+    double fileBytes  = 0.0; // standby list, i.e. cached file pages
+};
+
 struct DiskSample {
     double readBytesPerSec  = 0.0;
     double writeBytesPerSec = 0.0;
+    double transfersPerSec  = 0.0; // read + write operations
 };
 
 struct MetricsSnapshot {
@@ -28,6 +88,10 @@ struct MetricsSnapshot {
     MemorySample              memory;
     std::optional<NetSample>  net;  // may be unavailable
     std::optional<DiskSample> disk; // may be unavailable for MVP
+    std::optional<TcpSample>  tcp;
+    std::optional<IrqSample>  irq;
+
+    std::vector<NumaNodeSample> numa; // one per node, empty if unavailable
 };
 
 class MetricsCollector {
@@ -38,6 +102,9 @@ class MetricsCollector {
     bool            initialize();
     MetricsSnapshot sample();
     void            setSelectedNetworkInterface(int interfaceIndex); // -1 for auto-select
+    void            setIrqMatrixEnabled(bool enabled);               // per-CPU interrupt matrix, read only while enabled
+    void            setTcpDetailEnabled(bool enabled);               // RST/error rates and per-state socket table walks
+    void            setSerialNetTcp(bool serial);                    // before initialize(): skip PDH for network and TCP
 
   private:
     // CPU times
@@ -45,21 +112,91 @@ class MetricsCollector {
     unsigned long long prevKernel_ = 0;
     unsigned long long prevUser_   = 0;
 
-    // Network snapshot
-    unsigned long long prevRecv_             = 0; // aggregate interface selection
-    unsigned long long prevSent_             = 0;
-    bool               netInitialized_       = false;
-    int                selectedNetInterface_ = -1; // -1 = auto-select, else specific interface index
+    // Network snapshot (serial path)
+    unsigned long long         prevRecv_             = 0; // aggregate interface selection
+    unsigned long long         prevSent_             = 0;
+    bool                       netInitialized_       = false;
+    int                        selectedNetInterface_ = -1; // -1 = auto-select, else specific interface index
+    std::vector<unsigned char> ifTableBuf_;                // GetIfTable output, reused
+
+    // Network via the shared PDH query: "Network Interface" instances are matched to IP Helper rows by
+    // description, and the match is refreshed every NET_LAYOUT_REFRESH_MS or when the instance count changes.
+    enum NetCounter { NetRecv, NetSent, NetBandwidth, NetCounterCount };
+    void*              netCounters_[NetCounterCount] = {}; // PDH_HCOUNTER
+    bool               netPdhReady_                  = false;
+    std::vector<long>  netInstanceIf_;                     // PDH array item -> interface index, -1 if down or unmatched
+    int                netMatched_    = 0;                 // instances with an interface index
+    unsigned long long netLayoutTick_ = 0;
+
+    // TCP/UDP counters (raw 32-bit MIB values, summed over IPv4 and IPv6)
+    struct TcpCounters {
+        unsigned long retransSegs  = 0;
+        unsigned long outSegs      = 0;
+        unsigned long outRsts      = 0;
+        unsigned long estabResets  = 0;
+        unsigned long attemptFails = 0;
+        unsigned long inErrs       = 0;
+        unsigned long udpInErrors  = 0;
+        unsigned long currEstab    = 0; // gauge, not differenced
+    };
+    TcpCounters                prevTcp_{};
+    unsigned long long         prevTcpTick_    = 0;
+    bool                       tcpInitialized_ = false;
+    bool                       tcpDetail_      = false;
+    int                        tcpMode_        = -1; // sources behind prevTcp_; a change restarts the rates
+    std::vector<unsigned char> tcpTableBuf_; // reused across samples
+
+    // TCP/UDP via the shared PDH query, per family [IPv4, IPv6]. Segment rates are read directly; the
+    // connection and UDP error counts are raw totals, differenced like the MIB values.
+    enum TcpPdhCounter { TcpPdhRetrans, TcpPdhSent, TcpPdhResets, TcpPdhFailures, TcpPdhEstablished, TcpPdhUdpErrors, TcpPdhCount };
+    void* tcpCounters_[2][TcpPdhCount] = {}; // PDH_HCOUNTER; the IPv6 set may be missing
+    bool  tcpPdhReady_                 = false;
+
+    // Shared PDH query: every counter-based source registers into it (during initialize(), or on demand for
+    // the IRQ matrix), and sample() refreshes all of them with a single PdhCollectQueryData call per tick.
+    void* pdhQuery_     = nullptr; // PDH_HQUERY
+    bool  pdhCollected_ = false;   // last batch collection succeeded
+    bool  serialNetTcp_ = false;   // network and TCP stay on the IP Helper path even when PDH is available
+
+    // Per-CPU interrupt/DPC PDH counters (wildcard instances), registered only while the matrix is enabled.
+    // The instance -> CPU column layout is computed once and only rebuilt if the instance count changes.
+    void*                      irqCounters_[IrqSourceCount] = {};
+    void*                      ctxSwitchCounter_            = nullptr;
+    bool                       irqMatrixEnabled_            = false;
+    bool                       irqInitialized_              = false; // counters registered
+    int                        irqCpuCount_                 = 0;
+    std::vector<int>           irqColumnOf_; // PDH array item -> CPU column, -1 for _Total rows
+    std::vector<unsigned char> pdhArrayBuf_; // reused across samples
+
+    // NUMA: node count and the PDH instance -> node table are discovered once; each sample is a
+    // single pass that adds every CPU into its node's slot.
+    int                 numaNodes_          = 0;
+    void*               numaCpuCounter_     = nullptr;
+    void*               numaMemCounters_[3] = {}; // total, available, standby MB per node
+    std::vector<int>    numaNodeOf_;              // PDH array item -> node, numaNodes_ (discard slot) for _Total rows
+    std::vector<int>    numaMemNodeOf_;           // same for the NUMA Node Memory instances
+    std::vector<int>    numaNodeCpus_;            // CPUs per node with a valid value this sample, numaNodes_ + 1 slots
+    std::vector<double> numaSums_;                // per-node accumulator, numaNodes_ + 1 slots
 
     // Disk PDH
-    void*              pdhQuery_        = nullptr; // PDH_HQUERY
-    void*              pdhReadCounter_  = nullptr; // PDH_HCOUNTER
-    void*              pdhWriteCounter_ = nullptr; // PDH_HCOUNTER
-    bool               diskInitialized_ = false;
-    unsigned long long lastSampleTick_  = 0;
-
-    CpuSample                 sampleCpu();
-    MemorySample              sampleMemory();
-    std::optional<NetSample>  sampleNet();
-    std::optional<DiskSample> sampleDisk();
+    void*              pdhReadCounter_      = nullptr; // PDH_HCOUNTER
+    void*              pdhWriteCounter_     = nullptr; // PDH_HCOUNTER
+    void*              pdhTransfersCounter_ = nullptr; // PDH_HCOUNTER, optional
+    bool               diskInitialized_     = false;
+    unsigned long long lastSampleTick_      = 0;
+
+    void* addPdhCounter(const wchar_t* path); // PDH_HCOUNTER, nullptr if unavailable
+    bool  collectPdh();
+    void  updateIrqCounters();
+
+    CpuSample                   sampleCpu();
+    MemorySample                sampleMemory();
+    std::optional<NetSample>    sampleNet();
+    std::optional<NetSample>    sampleNetPdh();
+    std::optional<NetSample>    sampleNetSerial();
+    void                        buildNetLayout(const void* items, unsigned long count); // PDH_FMT_COUNTERVALUE_ITEM_W
+    std::optional<DiskSample>   sampleDisk();
+    std::optional<TcpSample>    sampleTcp();
+    std::optional<IrqSample>    sampleIrq();
+    std::vector<NumaNodeSample> sampleNuma();
 };
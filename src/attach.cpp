@@ -0,0 +1,253 @@
+#include "attach.hpp"
+
+#include <algorithm>
+#include <windows.h>
+// psapi.h and winternl.h rely on windows.h being included first
+#include <psapi.h>
+#include <winternl.h>
+
+// Thread cycle counts tick at the TSC rate on x86/x64, which __rdtsc calibrates against QPC directly.
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#include <intrin.h>
+#define WTOP_ATTACH_TSC 1
+#endif
+
+namespace {
+#ifndef WTOP_ATTACH_TSC
+unsigned long long fileTimeToULL(const FILETIME& ft) {
+    ULARGE_INTEGER ui;
+    ui.LowPart  = ft.dwLowDateTime;
+    ui.HighPart = ft.dwHighDateTime;
+    return ui.QuadPart;
+}
+#endif
+
+// SYSTEM_THREAD_INFORMATION as returned after each process entry; winternl.h hides ContextSwitches in a
+// reserved field.
+struct NtThreadInfo {
+    LARGE_INTEGER kernelTime;
+    LARGE_INTEGER userTime;
+    LARGE_INTEGER createTime;
+    ULONG         waitTime;
+    PVOID         startAddress;
+    CLIENT_ID     clientId;
+    LONG          priority;
+    LONG          basePriority;
+    ULONG         contextSwitches;
+    ULONG         threadState;
+    ULONG         waitReason;
+};
+
+using NtQuerySystemInformationFn = NTSTATUS(WINAPI*)(SYSTEM_INFORMATION_CLASS, PVOID, ULONG, PULONG);
+
+const NTSTATUS INFO_LENGTH_MISMATCH = (NTSTATUS) 0xC0000004L;
+} // namespace
+
+ProcessAttach::~ProcessAttach() {
+    detach();
+}
+
+bool ProcessAttach::attach(unsigned long pid) {
+    detach();
+    HANDLE h = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION | SYNCHRONIZE, FALSE, pid);
+    if (!h)
+        return false;
+    process_        = h;
+    pid_            = pid;
+    lastRescanTick_ = 0;
+    prevQpc_        = 0;
+    baseQpc_        = 0;
+    baseCycles_     = 0;
+    calibCycles_    = 0;
+    calibTime_      = 0;
+    cyclesPerSec_   = 0.0;
+    rescanThreads();
+    return true;
+}
+
+void ProcessAttach::detach() {
+    for (auto& t : threads_)
+        closeThread(t);
+    threads_.clear();
+    if (process_) {
+        CloseHandle(reinterpret_cast<HANDLE>(process_));
+        process_ = nullptr;
+    }
+    pid_ = 0;
+}
+
+void ProcessAttach::closeThread(ThreadState& t) {
+    if (t.handle) {
+        CloseHandle(reinterpret_cast<HANDLE>(t.handle));
+        t.handle = nullptr;
+    }
+}
+
+const void* ProcessAttach::findProcessInfo() {
+    static const auto query = reinterpret_cast<NtQuerySystemInformationFn>(
+        reinterpret_cast<void*>(GetProcAddress(GetModuleHandleW(L"ntdll.dll"), "NtQuerySystemInformation")));
+    if (!query)
+        return nullptr;
+    if (sysInfoBuf_.empty())
+        sysInfoBuf_.resize(256 * 1024);
+    for (;;) {
+        ULONG    needed = 0;
+        NTSTATUS st     = query(SystemProcessInformation, sysInfoBuf_.data(), (ULONG) sysInfoBuf_.size(), &needed);
+        if (st == INFO_LENGTH_MISMATCH) {
+            sysInfoBuf_.resize(std::max<size_t>(needed + 64 * 1024, sysInfoBuf_.size() * 2)); // processes come and go
+            continue;
+        }
+        if (st < 0)
+            return nullptr;
+        break;
+    }
+    const unsigned char* p = sysInfoBuf_.data();
+    for (;;) {
+        auto proc = reinterpret_cast<const SYSTEM_PROCESS_INFORMATION*>(p);
+        if ((ULONG_PTR) proc->UniqueProcessId == pid_)
+            return proc;
+        if (!proc->NextEntryOffset)
+            return nullptr;
+        p += proc->NextEntryOffset;
+    }
+}
+
+void ProcessAttach::rescanThreads() {
+    unsigned long long now      = GetTickCount64();
+    double             interval = lastRescanTick_ ? (double) (now - lastRescanTick_) / 1000.0 : 0.0;
+    lastRescanTick_             = now;
+    // One system-wide snapshot gives the thread list and per-thread context switch counts together.
+    auto proc = static_cast<const SYSTEM_PROCESS_INFORMATION*>(findProcessInfo());
+    if (!proc)
+        return;
+    auto info = reinterpret_cast<const NtThreadInfo*>(proc + 1);
+    scratchThreads_.clear();
+    for (ULONG k = 0; k < proc->NumberOfThreads; ++k) {
+        ThreadState s;
+        s.tid      = (unsigned long) (ULONG_PTR) info[k].clientId.UniqueThread;
+        s.switches = info[k].contextSwitches;
+        scratchThreads_.push_back(s);
+    }
+    std::sort(scratchThreads_.begin(), scratchThreads_.end(),
+              [](const ThreadState& a, const ThreadState& b) { return a.tid < b.tid; });
+
+    // Merge the sorted lists: keep known threads, close departed ones (this is where exited threads are retired),
+    // open new ones. mergeBuf_ and threads_ trade storage, so a steady thread count never reallocates.
+    mergeBuf_.clear();
+    size_t i = 0;
+    for (const ThreadState& s : scratchThreads_) {
+        while (i < threads_.size() && threads_[i].tid < s.tid)
+            closeThread(threads_[i++]);
+        if (i < threads_.size() && threads_[i].tid == s.tid) {
+            ThreadState t = threads_[i++];
+            t.switchRate  = interval > 0.0 ? (float) ((double) (s.switches - t.switches) / interval) : 0.0f;
+            t.switches    = s.switches;
+            mergeBuf_.push_back(t);
+            continue;
+        }
+        ThreadState t = s;
+        t.handle      = OpenThread(THREAD_QUERY_LIMITED_INFORMATION, FALSE, s.tid);
+        if (t.handle)
+            mergeBuf_.push_back(t);
+    }
+    while (i < threads_.size())
+        closeThread(threads_[i++]);
+    threads_.swap(mergeBuf_);
+}
+
+bool ProcessAttach::sample(AttachSample& out) {
+    out.threads.clear();
+    if (!process_)
+        return false;
+    HANDLE proc = reinterpret_cast<HANDLE>(process_);
+    if (WaitForSingleObject(proc, 0) == WAIT_OBJECT_0) {
+        detach();
+        return false;
+    }
+    if (GetTickCount64() - lastRescanTick_ >= rescanIntervalMs_)
+        rescanThreads();
+
+    LARGE_INTEGER qpc, freq;
+    QueryPerformanceCounter(&qpc);
+    QueryPerformanceFrequency(&freq);
+    double seconds = prevQpc_ ? (double) (qpc.QuadPart - prevQpc_) / (double) freq.QuadPart : 0.0;
+    prevQpc_       = qpc.QuadPart;
+#ifdef WTOP_ATTACH_TSC
+    // Calibrated over the whole attach, so read skew between the two counters fades out.
+    unsigned long long tsc = __rdtsc();
+    if (!baseQpc_) {
+        baseQpc_    = qpc.QuadPart;
+        baseCycles_ = tsc;
+    } else if (qpc.QuadPart > baseQpc_) {
+        cyclesPerSec_ = (double) (tsc - baseCycles_) * (double) freq.QuadPart / (double) (qpc.QuadPart - baseQpc_);
+    }
+#endif
+
+    out.pid                   = pid_;
+    out.cpu                   = 0.0f;
+    out.contextSwitchesPerSec = 0.0;
+    out.threads.reserve(threads_.size());
+    // CPU comes from cycle deltas: GetThreadTimes only advances at scheduler ticks (~15.6 ms), so over a 10-20 ms
+    // window it reads 0 or well above 100% for a thread that is actually half busy. A thread that exited since the
+    // last rescan still answers QueryThreadCycleTime (its count just stops), so it reads 0% until the rescan drops it.
+    size_t live = 0;
+    for (auto& t : threads_) {
+        HANDLE  h      = reinterpret_cast<HANDLE>(t.handle);
+        ULONG64 cycles = 0;
+        if (!QueryThreadCycleTime(h, &cycles)) {
+            closeThread(t); // compacted out below
+            continue;
+        }
+#ifndef WTOP_ATTACH_TSC
+        FILETIME create, exit, kernel, user;
+        if (GetThreadTimes(h, &create, &exit, &kernel, &user)) {
+            unsigned long long time = fileTimeToULL(kernel) + fileTimeToULL(user);
+            if (t.primed) {
+                calibCycles_ += cycles - t.prevCycles;
+                calibTime_ += time - t.prevTime;
+            }
+            t.prevTime = time;
+        }
+#endif
+
+        ThreadSample ts;
+        ts.tid                   = t.tid;
+        ts.contextSwitches       = t.switches;
+        ts.contextSwitchesPerSec = t.switchRate;
+        if (t.primed && seconds > 0.0) {
+            double rate     = (double) (cycles - t.prevCycles) / seconds;
+            ts.cyclesPerSec = (unsigned long long) rate;
+            if (cyclesPerSec_ > 0.0)
+                ts.cpu = (float) std::min(rate / cyclesPerSec_, 1.0);
+        }
+        t.prevCycles = cycles;
+        t.primed     = true;
+        out.cpu += ts.cpu;
+        out.contextSwitchesPerSec += ts.contextSwitchesPerSec;
+        out.threads.push_back(ts);
+        threads_[live++] = t;
+    }
+    threads_.resize(live);
+#ifndef WTOP_ATTACH_TSC
+    // Without a readable cycle counter, the cumulative cycles-per-CPU-second ratio converges as tick rounding
+    // errors stop growing relative to the totals.
+    if (calibTime_ > 0)
+        cyclesPerSec_ = (double) calibCycles_ * 1e7 / (double) calibTime_;
+#endif
+
+    PROCESS_MEMORY_COUNTERS pmc{};
+    pmc.cb = sizeof(pmc);
+    if (GetProcessMemoryInfo(proc, &pmc, sizeof(pmc)))
+        out.workingSetBytes = pmc.WorkingSetSize;
+
+    IO_COUNTERS io{};
+    if (GetProcessIoCounters(proc, &io)) {
+        if (seconds > 0.0) {
+            out.readBytesPerSec  = (double) (io.ReadTransferCount - prevReadBytes_) / seconds;
+            out.writeBytesPerSec = (double) (io.WriteTransferCount - prevWriteBytes_) / seconds;
+        }
+        prevReadBytes_  = io.ReadTransferCount;
+        prevWriteBytes_ = io.WriteTransferCount;
+    }
+    return true;
+}
@@ -0,0 +1,184 @@
+#include "decimate.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define WTOP_DECIMATE_SSE2 1
+#endif
+
+namespace {
+// Min/max over a contiguous run; four lanes at a time where SSE2 is available.
+void minMaxRange(const float* p, size_t n, float& mn, float& mx) {
+    size_t i = 0;
+#ifdef WTOP_DECIMATE_SSE2
+    if (n >= 4) {
+        __m128 vmin = _mm_loadu_ps(p);
+        __m128 vmax = vmin;
+        for (i = 4; i + 4 <= n; i += 4) {
+            __m128 v = _mm_loadu_ps(p + i);
+            vmin     = _mm_min_ps(vmin, v);
+            vmax     = _mm_max_ps(vmax, v);
+        }
+        alignas(16) float lo[4], hi[4];
+        _mm_store_ps(lo, vmin);
+        _mm_store_ps(hi, vmax);
+        for (int k = 0; k < 4; ++k) {
+            mn = std::min(mn, lo[k]);
+            mx = std::max(mx, hi[k]);
+        }
+    }
+#endif
+    for (; i < n; ++i) {
+        mn = std::min(mn, p[i]);
+        mx = std::max(mx, p[i]);
+    }
+}
+
+float sumRange(const float* p, size_t n) {
+    size_t i   = 0;
+    float  sum = 0.0f;
+#ifdef WTOP_DECIMATE_SSE2
+    __m128 acc = _mm_setzero_ps();
+    for (; i + 4 <= n; i += 4)
+        acc = _mm_add_ps(acc, _mm_loadu_ps(p + i));
+    alignas(16) float lanes[4];
+    _mm_store_ps(lanes, acc);
+    sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#endif
+    for (; i < n; ++i)
+        sum += p[i];
+    return sum;
+}
+
+// Calls fn(ptr, count, logicalStart) for each contiguous piece of [start, end) in the view.
+template <typename Fn> void forEachSegment(const RingView& view, size_t start, size_t end, Fn&& fn) {
+    if (start < view.firstLen) {
+        size_t stop = std::min(end, view.firstLen);
+        fn(view.first + start, stop - start, start);
+        start = stop;
+    }
+    if (start < end)
+        fn(view.second + (start - view.firstLen), end - start, start);
+}
+} // namespace
+
+RingView makeRingView(const std::vector<float>& buf, size_t nextIndex, size_t filled) {
+    RingView v;
+    size_t   cap = buf.size();
+    if (cap == 0 || filled == 0)
+        return v;
+    filled       = std::min(filled, cap);
+    nextIndex    = nextIndex % cap;
+    size_t start = (nextIndex + cap - filled) % cap;
+    v.first      = buf.data() + start;
+    if (start + filled <= cap) {
+        v.firstLen = filled;
+    } else {
+        v.firstLen  = cap - start;
+        v.second    = buf.data();
+        v.secondLen = filled - v.firstLen;
+    }
+    return v;
+}
+
+int decimateMinMax(const RingView& view, EnvelopeColumn* out, int columns) {
+    size_t n = view.size();
+    if (n == 0 || columns <= 0)
+        return 0;
+    size_t cols = std::min(n, (size_t) columns);
+    for (size_t c = 0; c < cols; ++c) {
+        size_t start = c * n / cols;
+        size_t end   = (c + 1) * n / cols;
+        float  mn    = view[start];
+        float  mx    = mn;
+        forEachSegment(view, start, end, [&](const float* p, size_t len, size_t) { minMaxRange(p, len, mn, mx); });
+        out[c] = {mn, mx};
+    }
+    return (int) cols;
+}
+
+int decimateLttb(const RingView& view, DecimatedPoint* out, int threshold) {
+    size_t n = view.size();
+    if (n == 0 || threshold <= 0)
+        return 0;
+    if ((size_t) threshold >= n || threshold < 3) {
+        size_t count = std::min(n, (size_t) threshold);
+        for (size_t i = 0; i < count; ++i)
+            out[i] = {(float) i, view[i]};
+        if (count >= 2)
+            out[count - 1] = {(float) (n - 1), view[n - 1]};
+        return (int) count;
+    }
+
+    double every = (double) (n - 2) / (double) (threshold - 2);
+    size_t a     = 0;
+    int    k     = 0;
+    out[k++]     = {0.0f, view[0]};
+    for (int i = 0; i < threshold - 2; ++i) {
+        // Average of the following bucket is the third vertex of the triangle.
+        size_t avgStart = (size_t) std::floor((i + 1) * every) + 1;
+        size_t avgEnd   = std::min((size_t) std::floor((i + 2) * every) + 1, n);
+        float  avgSum   = 0.0f;
+        forEachSegment(view, avgStart, avgEnd, [&](const float* p, size_t len, size_t) { avgSum += sumRange(p, len); });
+        float avgX = (float) (avgStart + avgEnd - 1) * 0.5f;
+        float avgY = avgSum / (float) (avgEnd - avgStart);
+
+        // area(j) = |dx * v[j] + dy * j + c| with the terms that do not depend on j hoisted.
+        float  ax       = (float) a;
+        float  ay       = view[a];
+        float  dx       = ax - avgX;
+        float  dy       = avgY - ay;
+        float  c        = -dx * ay - ax * dy;
+        size_t rangeLo  = (size_t) std::floor(i * every) + 1;
+        size_t rangeHi  = (size_t) std::floor((i + 1) * every) + 1;
+        float  maxArea  = -1.0f;
+        size_t maxIndex = rangeLo;
+        forEachSegment(view, rangeLo, rangeHi, [&](const float* p, size_t len, size_t base) {
+            for (size_t j = 0; j < len; ++j) {
+                float area = std::fabs(dx * p[j] + dy * (float) (base + j) + c);
+                if (area > maxArea) {
+                    maxArea  = area;
+                    maxIndex = base + j;
+                }
+            }
+        });
+        out[k++] = {(float) maxIndex, view[maxIndex]};
+        a        = maxIndex;
+    }
+    out[k++] = {(float) (n - 1), view[n - 1]};
+    return k;
+}
+
+void MinMaxEnvelope::reset(int columns, int samplesPerColumn) {
+    cols_.assign(std::max(columns, 1), EnvelopeColumn{});
+    samplesPerColumn_ = std::max(samplesPerColumn, 1);
+    pushed_           = 0;
+}
+
+void MinMaxEnvelope::push(float v) {
+    if (cols_.empty())
+        return;
+    unsigned long long bucket = pushed_ / (unsigned long long) samplesPerColumn_;
+    EnvelopeColumn&    col    = cols_[bucket % cols_.size()];
+    if (pushed_ % (unsigned long long) samplesPerColumn_ == 0) {
+        col = {v, v}; // first sample of a new bucket evicts the oldest column
+    } else {
+        col.min = std::min(col.min, v);
+        col.max = std::max(col.max, v);
+    }
+    pushed_++;
+}
+
+int MinMaxEnvelope::read(EnvelopeColumn* out, int maxColumns) const {
+    if (pushed_ == 0 || maxColumns <= 0)
+        return 0;
+    unsigned long long buckets = (pushed_ + samplesPerColumn_ - 1) / (unsigned long long) samplesPerColumn_;
+    size_t             count   = (size_t) std::min<unsigned long long>(buckets, cols_.size());
+    count                      = std::min(count, (size_t) maxColumns);
+    unsigned long long first   = buckets - count;
+    for (size_t i = 0; i < count; ++i)
+        out[i] = cols_[(first + i) % cols_.size()];
+    return (int) count;
+}
@@ -0,0 +1,319 @@
+#include "derived.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+
+// Recursive-descent parser that emits stack-machine code directly while tracking stack depth.
+class ExprCompiler {
+  public:
+    using Op    = DerivedMetrics::Op;
+    using Instr = DerivedMetrics::Instr;
+
+    ExprCompiler(const DerivedMetrics& metrics, const std::string& src, size_t firstState)
+        : nextState(firstState)
+        , metrics_(metrics)
+        , src_(src) {}
+
+    bool compile() {
+        parseExpr();
+        skipSpace();
+        if (error.empty() && pos_ < src_.size())
+            fail("unexpected '" + std::string(1, src_[pos_]) + "'");
+        return error.empty();
+    }
+
+    std::vector<Instr> code;
+    std::string        error;
+    size_t             nextState;
+
+  private:
+    const DerivedMetrics& metrics_;
+    const std::string&    src_;
+    size_t                pos_     = 0;
+    int                   depth_   = 0; // operand stack depth of the emitted code
+    int                   nesting_ = 0; // parser recursion depth
+
+    // Every recursion (parentheses, function arguments, unary minus) passes through parseUnary, so bounding it
+    // there keeps hostile input such as 30000 '(' from exhausting the native stack.
+    static const int MaxNesting = 64;
+
+    void fail(const std::string& msg) {
+        if (error.empty())
+            error = msg + " at column " + std::to_string(pos_ + 1);
+    }
+
+    void emit(Op op, int stackDelta, unsigned arg = 0, double k = 0.0) {
+        code.push_back({op, arg, k});
+        depth_ += stackDelta;
+        if (depth_ > DerivedMetrics::MaxStack)
+            fail("expression too deep");
+    }
+
+    void skipSpace() {
+        while (pos_ < src_.size() && std::isspace((unsigned char) src_[pos_]))
+            pos_++;
+    }
+
+    bool accept(char c) {
+        skipSpace();
+        if (pos_ < src_.size() && src_[pos_] == c) {
+            pos_++;
+            return true;
+        }
+        return false;
+    }
+
+    void expect(char c) {
+        if (!accept(c))
+            fail(std::string("expected '") + c + "'");
+    }
+
+    void parseExpr() {
+        parseTerm();
+        while (error.empty()) {
+            if (accept('+')) {
+                parseTerm();
+                emit(DerivedMetrics::Add, -1);
+            } else if (accept('-')) {
+                parseTerm();
+                emit(DerivedMetrics::Sub, -1);
+            } else {
+                break;
+            }
+        }
+    }
+
+    void parseTerm() {
+        parseUnary();
+        while (error.empty()) {
+            if (accept('*')) {
+                parseUnary();
+                emit(DerivedMetrics::Mul, -1);
+            } else if (accept('/')) {
+                parseUnary();
+                emit(DerivedMetrics::Div, -1);
+            } else {
+                break;
+            }
+        }
+    }
+
+    void parseUnary() {
+        if (++nesting_ > MaxNesting) {
+            fail("expression nested too deeply");
+        } else if (accept('-')) {
+            parseUnary();
+            emit(DerivedMetrics::Neg, 0);
+        } else {
+            parsePrimary();
+        }
+        nesting_--;
+    }
+
+    // Parses a parenthesised argument list; returns the argument count.
+    int parseArgs() {
+        int n = 0;
+        if (accept(')'))
+            return 0;
+        do {
+            parseExpr();
+            n++;
+        } while (error.empty() && accept(','));
+        expect(')');
+        return n;
+    }
+
+    void parsePrimary() {
+        skipSpace();
+        if (pos_ >= src_.size()) {
+            fail("unexpected end of expression");
+            return;
+        }
+        if (accept('(')) {
+            parseExpr();
+            expect(')');
+            return;
+        }
+        const char* start = src_.c_str() + pos_;
+        if (std::isdigit((unsigned char) *start) || *start == '.') {
+            char*  end = nullptr;
+            double v   = std::strtod(start, &end);
+            if (end == start) {
+                fail("malformed number");
+                return;
+            }
+            pos_ += (size_t) (end - start);
+            emit(DerivedMetrics::Const, 1, 0, v);
+            return;
+        }
+        if (!std::isalpha((unsigned char) *start) && *start != '_') {
+            fail("unexpected '" + std::string(1, *start) + "'");
+            return;
+        }
+        size_t begin = pos_;
+        while (pos_ < src_.size() && (std::isalnum((unsigned char) src_[pos_]) || src_[pos_] == '_'))
+            pos_++;
+        std::string ident = src_.substr(begin, pos_ - begin);
+
+        if (!accept('(')) {
+            auto it = std::find(metrics_.names_.begin(), metrics_.names_.end(), ident);
+            if (it == metrics_.names_.end()) {
+                fail("unknown name '" + ident + "'");
+                return;
+            }
+            emit(DerivedMetrics::Load, 1, (unsigned) (it - metrics_.names_.begin()));
+            return;
+        }
+
+        struct Function {
+            const char* name;
+            int         args;
+            Op          op;
+            bool        stateful;
+        };
+        static const Function functions[] = {
+            {"min", 2, DerivedMetrics::Min, false},    {"max", 2, DerivedMetrics::Max, false},
+            {"clamp", 3, DerivedMetrics::Clamp, false}, {"abs", 1, DerivedMetrics::Abs, false},
+            {"rate", 1, DerivedMetrics::Rate, true},    {"ewma", 2, DerivedMetrics::Ewma, true},
+        };
+        for (const auto& f : functions) {
+            if (ident != f.name)
+                continue;
+            int n = parseArgs();
+            if (!error.empty())
+                return;
+            if (n != f.args) {
+                fail(ident + "() takes " + std::to_string(f.args) + " argument(s)");
+                return;
+            }
+            emit(f.op, 1 - f.args, f.stateful ? (unsigned) nextState++ : 0);
+            return;
+        }
+        fail("unknown function '" + ident + "'");
+    }
+};
+
+DerivedMetrics::DerivedMetrics(std::vector<std::string> inputs)
+    : inputCount_(inputs.size())
+    , names_(std::move(inputs))
+    , regs_(names_.size(), 0.0) {}
+
+bool DerivedMetrics::add(const std::string& name, const std::string& expression, std::string* error) {
+    auto setError = [&](const std::string& msg) {
+        if (error)
+            *error = name + ": " + msg;
+        return false;
+    };
+    bool validName = !name.empty() && (std::isalpha((unsigned char) name[0]) || name[0] == '_') &&
+                     std::all_of(name.begin(), name.end(), [](char c) { return std::isalnum((unsigned char) c) || c == '_'; });
+    if (!validName)
+        return setError("invalid name");
+    if (std::find(names_.begin(), names_.end(), name) != names_.end())
+        return setError("name already defined");
+
+    ExprCompiler compiler(*this, expression, state_.size());
+    if (!compiler.compile())
+        return setError(compiler.error);
+
+    unsigned reg = (unsigned) names_.size();
+    code_.insert(code_.end(), compiler.code.begin(), compiler.code.end());
+    code_.push_back({Store, reg, 0.0});
+    names_.push_back(name);
+    regs_.push_back(0.0);
+    state_.resize(compiler.nextState, std::numeric_limits<double>::quiet_NaN());
+    return true;
+}
+
+void DerivedMetrics::clear() {
+    names_.resize(inputCount_);
+    regs_.resize(inputCount_);
+    state_.clear();
+    code_.clear();
+}
+
+int DerivedMetrics::find(const std::string& name) const {
+    for (size_t i = inputCount_; i < names_.size(); ++i) {
+        if (names_[i] == name)
+            return (int) (i - inputCount_);
+    }
+    return -1;
+}
+
+bool DerivedMetrics::usesInput(size_t input) const {
+    return std::any_of(code_.begin(), code_.end(), [&](const Instr& in) { return in.op == Load && in.arg == input; });
+}
+
+void DerivedMetrics::evaluate(const double* inputs, double dtSeconds) {
+    std::copy(inputs, inputs + inputCount_, regs_.begin());
+    double  stack[MaxStack];
+    int     sp    = 0;
+    double  invDt = dtSeconds > 0.0 ? 1.0 / dtSeconds : 0.0;
+    double* regs  = regs_.data();
+    double* state = state_.data();
+    for (const Instr& in : code_) {
+        switch (in.op) {
+            case Const:
+                stack[sp++] = in.k;
+                break;
+            case Load:
+                stack[sp++] = regs[in.arg];
+                break;
+            case Store:
+                regs[in.arg] = stack[--sp];
+                break;
+            case Add:
+                sp--;
+                stack[sp - 1] += stack[sp];
+                break;
+            case Sub:
+                sp--;
+                stack[sp - 1] -= stack[sp];
+                break;
+            case Mul:
+                sp--;
+                stack[sp - 1] *= stack[sp];
+                break;
+            case Div:
+                sp--;
+                stack[sp - 1] = stack[sp] != 0.0 ? stack[sp - 1] / stack[sp] : 0.0;
+                break;
+            case Neg:
+                stack[sp - 1] = -stack[sp - 1];
+                break;
+            case Min:
+                sp--;
+                stack[sp - 1] = std::min(stack[sp - 1], stack[sp]);
+                break;
+            case Max:
+                sp--;
+                stack[sp - 1] = std::max(stack[sp - 1], stack[sp]);
+                break;
+            case Clamp:
+                sp -= 2;
+                stack[sp - 1] = std::min(std::max(stack[sp - 1], stack[sp]), stack[sp + 1]);
+                break;
+            case Abs:
+                stack[sp - 1] = std::fabs(stack[sp - 1]);
+                break;
+            case Rate: {
+                double x      = stack[sp - 1];
+                double prev   = state[in.arg];
+                stack[sp - 1] = std::isnan(prev) ? 0.0 : (x - prev) * invDt;
+                state[in.arg] = x;
+                break;
+            }
+            case Ewma: {
+                sp--;
+                double x      = stack[sp - 1];
+                double s      = state[in.arg];
+                s             = std::isnan(s) ? x : s + stack[sp] * (x - s);
+                state[in.arg] = s;
+                stack[sp - 1] = s;
+                break;
+            }
+        }
+    }
+}
@@ -9,6 +9,9 @@
 #define NOMINMAX
 #endif
 
+#include "attach.hpp"
+#include "decimate.hpp"
+#include "derived.hpp"
 #include "metrics.hpp"
 
 #include <algorithm>
@@ -29,16 +32,49 @@ static const int GRAPH_SPACING      = 4; // space between graphs
 static const int PADDING_X          = 6;
 static const int PADDING_Y          = 4;
 static const int UPDATE_INTERVAL_MS = 1000; // 1s sampling
+static const int SAMPLES_PER_COLUMN = 10;   // each graph column covers this many samples
+static const int HISTORY_LENGTH     = GRAPH_WIDTH * SAMPLES_PER_COLUMN;
 
-struct Histories {
-    std::vector<float> cpu;
-    std::vector<float> mem;
-    std::vector<float> net; // utilization 0..1
-} histories;
+static const UINT WM_ATTACH_EXITED = WM_APP + 2; // posted by the attach sampler thread
+
+// Before Windows 10 1803 SDKs; CreateWaitableTimerExW rejects it on older systems and we fall back
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
 
 static size_t historyIndex  = 0;
 static bool   historyFilled = false;
 
+// Heatmap rows are scaled to the busiest CPU, but never below these levels so an idle box stays dark
+static const float IRQ_HEATMAP_FLOOR[IrqSourceCount] = {1000.f, 1000.f, 10.f, 10.f}; // per sec, per sec, %, %
+
+// One graphed series: ring buffer of HISTORY_LENGTH samples (indexed by historyIndex) plus its envelope
+struct SeriesHistory {
+    std::vector<float> values;
+    MinMaxEnvelope     env;
+    bool               autoScale = false; // false: values are clamped to 0..1; true: raw, drawn against the window max
+
+    void reset() {
+        values.assign(HISTORY_LENGTH, 0.f);
+        env.reset(GRAPH_WIDTH, SAMPLES_PER_COLUMN);
+    }
+    void push(float v) {
+        if (!autoScale)
+            v = std::clamp(v, 0.f, 1.f);
+        values[historyIndex] = v;
+        env.push(v);
+    }
+};
+
+struct Histories {
+    SeriesHistory              cpu;
+    SeriesHistory              mem;
+    SeriesHistory              net;     // utilization 0..1
+    std::vector<SeriesHistory> numaCpu; // per NUMA node
+    std::vector<SeriesHistory> numaMem;
+    std::vector<SeriesHistory> derived; // parallel to g_derivedGraphs
+} histories;
+
 // Window / state
 static HWND             g_hwnd              = nullptr;
 static bool             g_clickThrough      = true;
@@ -49,14 +85,188 @@ static NOTIFYICONDATA   g_nid{};
 static MetricsCollector g_metrics;
 static MetricsSnapshot  g_lastSnap{};
 
+// Attach mode (--attach <pid> [--hz <10..100>]). g_attach belongs to the sampler thread once it starts; the
+// UI thread only reads g_attachSample, refreshed from g_attachLatest once per overlay update.
+static ProcessAttach g_attach;
+static AttachSample  g_attachSample;
+static bool          g_attachActive   = false;
+static unsigned long g_attachPid      = 0;
+static int           g_attachHz       = 50;
+static float         g_attachPeakShow = 0.f; // peak over the interval currently displayed
+static HANDLE        g_attachThread   = nullptr;
+static HANDLE        g_attachStop     = nullptr; // event that ends the sampler thread
+static SRWLOCK       g_attachLock     = SRWLOCK_INIT;
+static AttachSample  g_attachLatest;            // guarded by g_attachLock
+static float         g_attachPeakCpu  = 0.f;    // guarded; highest process CPU since the last overlay update
+
+// Derived metrics ([derived] name=expression in settings.ini). Inputs are snapshot fields in this order.
+enum DerivedInput {
+    InCpu,
+    InMem,
+    InMemTotal,
+    InMemUsed,
+    InMemAvail,
+    InMemCache,
+    InNetRecv,
+    InNetSent,
+    InNetLink,
+    InDiskRead,
+    InDiskWrite,
+    InDiskIops,
+    InTcpRetrans,
+    InTcpRetransRatio,
+    InTcpOutResets,
+    InTcpEstabResets,
+    InTcpAttemptFails,
+    InTcpInErrors,
+    InUdpInErrors,
+    InTcpStates, // one input per TcpState, in enum order
+    InContextSwitches = InTcpStates + TcpStateCount,
+    InAttachCpu,
+    InAttachRss,
+    InAttachCsw,
+    DerivedInputCount
+};
+static const char* const DERIVED_INPUT_NAMES[] = {
+    "cpu", "mem", "mem_total", "mem_used", "mem_avail", "mem_cache", "net_recv", "net_sent", "net_link",
+    "disk_read", "disk_write", "disk_iops", "tcp_retrans", "tcp_retrans_ratio", "tcp_out_resets", "tcp_estab_resets",
+    "tcp_attempt_fails", "tcp_in_errors", "udp_in_errors",
+    // socket counts per TcpState
+    "tcp_closed", "tcp_listen", "tcp_syn_sent", "tcp_syn_rcvd", "tcp_established", "tcp_fin_wait1", "tcp_fin_wait2",
+    "tcp_close_wait", "tcp_closing", "tcp_last_ack", "tcp_time_wait", "tcp_delete_tcb",
+    "csw", "attach_cpu", "attach_rss", "attach_csw",
+};
+static_assert(std::size(DERIVED_INPUT_NAMES) == DerivedInputCount, "one name per DerivedInput");
+// Built-in metric 0; drives the NET graph
+static const char* const NET_UTIL_EXPR   = "clamp(max(net_recv, net_sent) / (net_link / 8), 0, 1)";
+static const int         NET_UTIL_METRIC = 0;
+
+static DerivedMetrics     g_derived(std::vector<std::string>(DERIVED_INPUT_NAMES, DERIVED_INPUT_NAMES + DerivedInputCount));
+static double             g_derivedInputs[DerivedInputCount] = {};
+static std::vector<int>   g_derivedGraphs;  // metric indices listed in [graphs] derived=
+static std::vector<int>   g_derivedOverlay; // metric indices listed in [overlay] derived=, shown in the text line
+static unsigned long long g_lastDerivedTick = 0;
+
 // Network interface selection
 static std::vector<std::pair<std::wstring, DWORD>> g_availableInterfaces;
 static int                                         g_selectedInterfaceIndex = -1; // -1 = auto-select fastest
 
 // Graph visibility flags (persisted)
-static bool g_showCpuGraph = true;
-static bool g_showMemGraph = true;
-static bool g_showNetGraph = true;
+static bool g_showCpuGraph   = true;
+static bool g_showMemGraph   = true;
+static bool g_showNetGraph   = true;
+static bool g_showIrqGraph   = false; // per-CPU interrupt/DPC heatmap
+static bool g_showNumaGraphs = false; // CPU and memory graph per NUMA node
+static bool g_graphLttb      = false; // false = min/max envelope, true = LTTB polyline
+
+static int ActiveGraphCount() {
+    int numaGraphs = g_showNumaGraphs ? 2 * (int) histories.numaCpu.size() : 0;
+    return (g_showCpuGraph ? 1 : 0) + (g_showMemGraph ? 1 : 0) + (g_showNetGraph ? 1 : 0) + (g_showIrqGraph ? 1 : 0) + numaGraphs +
+           (int) g_derivedGraphs.size();
+}
+
+static void FillDerivedInputs(const MetricsSnapshot& snap, double* in) {
+    std::fill(in, in + DerivedInputCount, 0.0);
+    in[InCpu]      = snap.cpu.usage;
+    in[InMem]      = snap.memory.usage;
+    in[InMemTotal] = snap.memory.totalBytes;
+    in[InMemUsed]  = snap.memory.totalBytes - snap.memory.availBytes;
+    in[InMemAvail] = snap.memory.availBytes;
+    in[InMemCache] = snap.memory.cacheBytes;
+    if (snap.net) {
+        in[InNetRecv] = snap.net->bytesRecvPerSec;
+        in[InNetSent] = snap.net->bytesSentPerSec;
+        in[InNetLink] = (double) snap.net->linkSpeedBitsPerSec;
+    }
+    if (snap.disk) {
+        in[InDiskRead]  = snap.disk->readBytesPerSec;
+        in[InDiskWrite] = snap.disk->writeBytesPerSec;
+        in[InDiskIops]  = snap.disk->transfersPerSec;
+    }
+    if (snap.tcp) {
+        in[InTcpRetrans]      = snap.tcp->retransSegsPerSec;
+        in[InTcpRetransRatio] = snap.tcp->retransRatio;
+        in[InTcpOutResets]    = snap.tcp->outResetsPerSec;
+        in[InTcpEstabResets]  = snap.tcp->estabResetsPerSec;
+        in[InTcpAttemptFails] = snap.tcp->attemptFailsPerSec;
+        in[InTcpInErrors]     = snap.tcp->inErrorsPerSec;
+        in[InUdpInErrors]     = snap.tcp->udpInErrorsPerSec;
+        for (int s = 0; s < TcpStateCount; ++s)
+            in[InTcpStates + s] = snap.tcp->socketsByState[s];
+    }
+    if (snap.irq)
+        in[InContextSwitches] = snap.irq->contextSwitchesPerSec;
+    if (g_attachActive) {
+        in[InAttachCpu] = g_attachSample.cpu;
+        in[InAttachRss] = (double) g_attachSample.workingSetBytes;
+        in[InAttachCsw] = g_attachSample.contextSwitchesPerSec;
+    }
+}
+
+static std::string TrimAscii(const std::string& s) {
+    size_t b = s.find_first_not_of(" \t");
+    size_t e = s.find_last_not_of(" \t");
+    return b == std::string::npos ? std::string() : s.substr(b, e - b + 1);
+}
+
+static std::string ToUtf8(const wchar_t* w) {
+    int         len = WideCharToMultiByte(CP_UTF8, 0, w, -1, nullptr, 0, nullptr, nullptr);
+    std::string out(len > 0 ? len - 1 : 0, '\0');
+    if (len > 1)
+        WideCharToMultiByte(CP_UTF8, 0, w, -1, out.data(), len, nullptr, nullptr);
+    return out;
+}
+
+// Appends the metrics named in a comma-separated `derived=` list of the given section; unknown names go to errors.
+static void ParseDerivedList(const std::wstring& path, const wchar_t* section, std::vector<int>& out, std::string& errors) {
+    out.clear();
+    wchar_t list[1024];
+    GetPrivateProfileStringW(section, L"derived", L"", list, 1024, path.c_str());
+    std::string names = ToUtf8(list);
+    for (size_t start = 0; start < names.size();) {
+        size_t      comma = names.find(',', start);
+        std::string name  = TrimAscii(names.substr(start, comma == std::string::npos ? std::string::npos : comma - start));
+        start             = comma == std::string::npos ? names.size() : comma + 1;
+        if (name.empty())
+            continue;
+        int metric = g_derived.find(name);
+        if (metric < 0)
+            errors += ToUtf8(section) + ": unknown derived metric '" + name + "'\n";
+        else
+            out.push_back(metric);
+    }
+}
+
+// Compiles [derived] once at startup; bad entries are skipped and reported together.
+static void LoadDerivedMetrics(const std::wstring& path) {
+    g_derived.clear();
+    g_derived.add("net_util", NET_UTIL_EXPR);
+
+    std::string          errors;
+    std::vector<wchar_t> section(32768);
+    DWORD                len = GetPrivateProfileSectionW(L"derived", section.data(), (DWORD) section.size(), path.c_str());
+    for (const wchar_t* entry = section.data(); entry < section.data() + len && *entry; entry += wcslen(entry) + 1) {
+        std::string line = ToUtf8(entry);
+        size_t      eq   = line.find('=');
+        std::string err;
+        if (eq == std::string::npos || line[0] == ';')
+            continue;
+        if (!g_derived.add(TrimAscii(line.substr(0, eq)), line.substr(eq + 1), &err))
+            errors += err + "\n";
+    }
+
+    ParseDerivedList(path, L"graphs", g_derivedGraphs, errors);
+    ParseDerivedList(path, L"overlay", g_derivedOverlay, errors);
+
+    // The PDH counters cover the other TCP inputs; these need the IP Helper statistics and socket table walks
+    bool tcpDetail = g_derived.usesInput(InTcpOutResets) || g_derived.usesInput(InTcpInErrors);
+    for (int s = 0; s < TcpStateCount; ++s)
+        tcpDetail = tcpDetail || (s != TcpEstablished && g_derived.usesInput(InTcpStates + s));
+    g_metrics.setTcpDetailEnabled(tcpDetail);
+
+    if (!errors.empty())
+        MessageBoxA(nullptr, errors.c_str(), "wtop: derived metrics", MB_OK | MB_ICONWARNING);
+}
 
 // Settings persistence
 static std::wstring GetSettingsPath() {
@@ -85,6 +295,14 @@ static void LoadSettings() {
         g_showMemGraph = (_wtoi(buf) != 0);
     if (GetPrivateProfileStringW(L"graphs", L"show_net", L"1", buf, 64, path.c_str()))
         g_showNetGraph = (_wtoi(buf) != 0);
+    if (GetPrivateProfileStringW(L"graphs", L"show_irq", L"0", buf, 64, path.c_str()))
+        g_showIrqGraph = (_wtoi(buf) != 0);
+    g_metrics.setIrqMatrixEnabled(g_showIrqGraph);
+    if (GetPrivateProfileStringW(L"graphs", L"show_numa", L"0", buf, 64, path.c_str()))
+        g_showNumaGraphs = (_wtoi(buf) != 0);
+    if (GetPrivateProfileStringW(L"graphs", L"lttb", L"0", buf, 64, path.c_str()))
+        g_graphLttb = (_wtoi(buf) != 0);
+    LoadDerivedMetrics(path);
 }
 
 static void SaveSettings() {
@@ -95,6 +313,9 @@ static void SaveSettings() {
     WritePrivateProfileStringW(L"graphs", L"show_cpu", g_showCpuGraph ? L"1" : L"0", path.c_str());
     WritePrivateProfileStringW(L"graphs", L"show_mem", g_showMemGraph ? L"1" : L"0", path.c_str());
     WritePrivateProfileStringW(L"graphs", L"show_net", g_showNetGraph ? L"1" : L"0", path.c_str());
+    WritePrivateProfileStringW(L"graphs", L"show_irq", g_showIrqGraph ? L"1" : L"0", path.c_str());
+    WritePrivateProfileStringW(L"graphs", L"show_numa", g_showNumaGraphs ? L"1" : L"0", path.c_str());
+    WritePrivateProfileStringW(L"graphs", L"lttb", g_graphLttb ? L"1" : L"0", path.c_str());
 }
 
 // Forward declarations
@@ -106,38 +327,107 @@ std::string BuildOverlayLine(const MetricsSnapshot& snap);
 void        EnumerateNetworkInterfaces();
 void        ShowContextMenu(HWND hwnd);
 
+// USER timers are clamped to roughly 64 Hz, so attach sampling runs on its own thread paced by a high-resolution
+// waitable timer. Deadlines advance by a fixed period, so rounding in one wait does not accumulate as drift.
+static DWORD WINAPI AttachSamplerThread(LPVOID param) {
+    HWND   hwnd  = (HWND) param;
+    HANDLE timer = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+    if (!timer)
+        timer = CreateWaitableTimerExW(nullptr, nullptr, 0, TIMER_ALL_ACCESS);
+    if (!timer)
+        return 1;
+    LARGE_INTEGER freq, now;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&now);
+    long long    period   = freq.QuadPart / g_attachHz;
+    long long    deadline = now.QuadPart;
+    HANDLE       waits[2] = {g_attachStop, timer};
+    AttachSample sample;
+    for (;;) {
+        deadline += period;
+        QueryPerformanceCounter(&now);
+        if (deadline < now.QuadPart)
+            deadline = now.QuadPart; // fell behind (e.g. suspended); skip rather than burst
+        LARGE_INTEGER due;
+        due.QuadPart = -std::max(1LL, (deadline - now.QuadPart) * 10000000LL / freq.QuadPart); // relative, 100ns
+        SetWaitableTimer(timer, &due, 0, nullptr, nullptr, FALSE);
+        if (WaitForMultipleObjects(2, waits, FALSE, INFINITE) != WAIT_OBJECT_0 + 1)
+            break;
+        bool alive = g_attach.sample(sample);
+        if (alive) {
+            AcquireSRWLockExclusive(&g_attachLock);
+            g_attachLatest  = sample; // copy-assignment reuses the threads vector's capacity
+            g_attachPeakCpu = std::max(g_attachPeakCpu, sample.cpu);
+            ReleaseSRWLockExclusive(&g_attachLock);
+        } else {
+            PostMessage(hwnd, WM_ATTACH_EXITED, 0, 0);
+            break;
+        }
+    }
+    CloseHandle(timer);
+    return 0;
+}
+
 LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
     switch (msg) {
         case WM_CREATE: {
             SetTimer(hwnd, 1, UPDATE_INTERVAL_MS, nullptr);
+            if (g_attachActive) {
+                g_attachStop   = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+                g_attachThread = CreateThread(nullptr, 0, AttachSamplerThread, hwnd, 0, nullptr);
+                if (g_attachThread)
+                    SetThreadPriority(g_attachThread, THREAD_PRIORITY_ABOVE_NORMAL);
+            }
             break;
         }
         case WM_TIMER: {
+            if (g_attachActive) {
+                AcquireSRWLockExclusive(&g_attachLock);
+                g_attachSample   = g_attachLatest;
+                g_attachPeakShow = g_attachPeakCpu;
+                g_attachPeakCpu  = 0.f;
+                ReleaseSRWLockExclusive(&g_attachLock);
+            }
             g_lastSnap = g_metrics.sample();
-            if (histories.cpu.empty()) {
-                histories.cpu.assign(GRAPH_WIDTH, 0.f);
-                histories.mem.assign(GRAPH_WIDTH, 0.f);
-                histories.net.assign(GRAPH_WIDTH, 0.f);
+            if (histories.cpu.values.empty()) {
+                histories.cpu.reset();
+                histories.mem.reset();
+                histories.net.reset();
+                // Node count is fixed for the life of the process; size per-node series from the first snapshot
+                histories.numaCpu.resize(g_lastSnap.numa.size());
+                histories.numaMem.resize(g_lastSnap.numa.size());
+                for (size_t n = 0; n < g_lastSnap.numa.size(); ++n) {
+                    histories.numaCpu[n].reset();
+                    histories.numaMem[n].reset();
+                }
+                histories.derived.resize(g_derivedGraphs.size());
+                for (auto& series : histories.derived) {
+                    series.reset();
+                    series.autoScale = true; // derived values have arbitrary units (bytes/s, counts, ratios)
+                }
                 historyIndex  = 0;
                 historyFilled = false;
+                if (g_showNumaGraphs && !histories.numaCpu.empty()) {
+                    g_frozenWidth = false; // graph count changed now that the node count is known
+                    RecomputeAndResize();
+                }
             }
-            auto push = [](std::vector<float>& h, float v) { h[historyIndex] = std::clamp(v, 0.f, 1.f); };
-            push(histories.cpu, g_lastSnap.cpu.usage);
-            push(histories.mem, g_lastSnap.memory.usage);
-            float netUtil = 0.f;
-            if (g_lastSnap.net && g_lastSnap.net->linkSpeedBitsPerSec > 0) {
-                double maxBytes       = std::max(g_lastSnap.net->bytesRecvPerSec, g_lastSnap.net->bytesSentPerSec);
-                double capBytesPerSec = (double) g_lastSnap.net->linkSpeedBitsPerSec / 8.0;
-                if (capBytesPerSec > 0.0)
-                    netUtil = (float) (maxBytes / capBytesPerSec);
+            auto nowTick = GetTickCount64();
+            FillDerivedInputs(g_lastSnap, g_derivedInputs);
+            g_derived.evaluate(g_derivedInputs, g_lastDerivedTick ? (double) (nowTick - g_lastDerivedTick) / 1000.0 : 0.0);
+            g_lastDerivedTick = nowTick;
+
+            histories.cpu.push(g_lastSnap.cpu.usage);
+            histories.mem.push(g_lastSnap.memory.usage);
+            histories.net.push((float) g_derived.value(NET_UTIL_METRIC));
+            for (size_t i = 0; i < histories.derived.size(); ++i)
+                histories.derived[i].push((float) g_derived.value(g_derivedGraphs[i]));
+            for (size_t n = 0; n < histories.numaCpu.size() && n < g_lastSnap.numa.size(); ++n) {
+                histories.numaCpu[n].push(g_lastSnap.numa[n].cpuUsage);
+                histories.numaMem[n].push(g_lastSnap.numa[n].memUsage);
             }
-            if (netUtil < 0.f)
-                netUtil = 0.f;
-            if (netUtil > 1.f)
-                netUtil = 1.f;
-            push(histories.net, netUtil);
             historyIndex++;
-            if (historyIndex >= histories.cpu.size()) {
+            if (historyIndex >= histories.cpu.values.size()) {
                 historyIndex  = 0;
                 historyFilled = true;
             }
@@ -162,16 +452,21 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
             std::string line    = BuildOverlayLine(g_lastSnap);
             SIZE        sz{};
             GetTextExtentPoint32A(hdc, line.c_str(), (int) line.size(), &sz);
-            if (!g_frozenWidth) {
-                int activeGraphs    = (g_showCpuGraph ? 1 : 0) + (g_showMemGraph ? 1 : 0) + (g_showNetGraph ? 1 : 0);
-                int graphsWidth     = activeGraphs > 0 ? (GRAPH_WIDTH * activeGraphs) + (GRAPH_SPACING * (activeGraphs - 1)) : 0;
-                g_frozenWidth       = true;
-                g_frozenWindowWidth = sz.cx + PADDING_X * 2 + graphsWidth + (activeGraphs > 0 ? 8 : 0);
-                RecomputeAndResize();
+            // The first paint precedes the first sample, so segments that only appear once data arrives (TCP,
+            // CSW, derived values) can widen the line later; the frozen width only ever grows to fit them.
+            {
+                int activeGraphs = ActiveGraphCount();
+                int graphsWidth  = activeGraphs > 0 ? (GRAPH_WIDTH * activeGraphs) + (GRAPH_SPACING * (activeGraphs - 1)) : 0;
+                int needed       = sz.cx + PADDING_X * 2 + graphsWidth + (activeGraphs > 0 ? 8 : 0);
+                if (!g_frozenWidth || needed > g_frozenWindowWidth) {
+                    g_frozenWidth       = true;
+                    g_frozenWindowWidth = needed;
+                    RecomputeAndResize();
+                }
             }
 
             // Draw text with shadow effect for better readability
-            int activeGraphs = (g_showCpuGraph ? 1 : 0) + (g_showMemGraph ? 1 : 0) + (g_showNetGraph ? 1 : 0);
+            int activeGraphs = ActiveGraphCount();
             int graphsWidth  = activeGraphs > 0 ? (GRAPH_WIDTH * activeGraphs) + (GRAPH_SPACING * (activeGraphs - 1)) : 0;
             int textX        = PADDING_X + graphsWidth + (activeGraphs > 0 ? 8 : 0);
             int textY        = PADDING_Y;
@@ -186,7 +481,7 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
             TextOutA(hdc, textX, textY, line.c_str(), (int) line.size());
 
             // Draw graphs with labels and scale
-            auto drawGraphWithLabel = [&](const std::vector<float>& h, int offsetX, COLORREF color, const char* label) {
+            auto drawGraphWithLabel = [&](const SeriesHistory& series, int offsetX, COLORREF color, const char* label) {
                 // Draw label below graph
                 SetTextColor(hdc, RGB(180, 180, 180));
                 SetBkMode(hdc, TRANSPARENT);
@@ -216,25 +511,43 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
                 HPEN pen    = CreatePen(PS_SOLID, 2, color); // Thicker line for visibility
                 HPEN oldPen = (HPEN) SelectObject(hdc, pen);
 
-                int count = (int) h.size();
-
-                // Draw oldest on the left, newest on the right.
-                // historyIndex always points to the slot to be written next (i.e., newest just written is at (historyIndex-1+count)%count)
-                int filled = historyFilled ? count : (int) historyIndex; // number of valid samples
-                if (filled > 0) {
-                    bool hasPreviousPoint = false;
-                    for (int i = 0; i < filled; ++i) {
-                        // Map i (0..filled-1) to circular buffer index: oldest = (historyIndex - filled + i + count) % count
-                        int   histIdx = (historyIndex - filled + i + count) % count;
-                        float value   = std::clamp(h[histIdx], 0.f, 1.f);
-                        int   x       = offsetX + i; // left to right progression
-                        int   y       = baseY - (int) std::round(value * (GRAPH_HEIGHT - 1));
-                        if (!hasPreviousPoint) {
-                            MoveToEx(hdc, x, y, nullptr);
-                            hasPreviousPoint = true;
-                        } else {
-                            LineTo(hdc, x, y);
-                        }
+                // historyIndex always points to the slot to be written next
+                size_t   filled = historyFilled ? series.values.size() : historyIndex;
+                RingView view   = makeRingView(series.values, historyIndex, filled);
+                // Auto-scaled series are stretched so the largest value in the window touches the top line
+                float scale = 1.f;
+                if (series.autoScale) {
+                    EnvelopeColumn range;
+                    if (decimateMinMax(view, &range, 1) == 1 && range.max > 0.f)
+                        scale = 1.f / range.max;
+                }
+
+                // Draw oldest on the left, newest on the right; HISTORY_LENGTH samples are reduced to GRAPH_WIDTH columns.
+                auto toY = [&](float v) { return baseY - (int) std::round(std::clamp(v * scale, 0.f, 1.f) * (GRAPH_HEIGHT - 1)); };
+                if (g_graphLttb) {
+                    DecimatedPoint pts[GRAPH_WIDTH];
+                    int            n      = decimateLttb(view, pts, GRAPH_WIDTH);
+                    float          xScale = (float) (GRAPH_WIDTH - 1) / (float) (HISTORY_LENGTH - 1);
+                    for (int i = 0; i < n; ++i) {
+                        int x = offsetX + (int) std::round(pts[i].x * xScale);
+                        if (i == 0)
+                            MoveToEx(hdc, x, toY(pts[i].y), nullptr);
+                        else
+                            LineTo(hdc, x, toY(pts[i].y));
+                    }
+                } else {
+                    // Each column spans its bucket's min..max so short spikes stay visible.
+                    EnvelopeColumn cols[GRAPH_WIDTH];
+                    int            n = series.env.read(cols, GRAPH_WIDTH);
+                    for (int i = 0; i < n; ++i) {
+                        int x    = offsetX + i;
+                        int yMax = toY(cols[i].max);
+                        int yMin = toY(cols[i].min);
+                        if (i == 0)
+                            MoveToEx(hdc, x, yMin, nullptr);
+                        else
+                            LineTo(hdc, x, yMin); // join with the previous column
+                        LineTo(hdc, x, yMax);
                     }
                 }
 
@@ -242,7 +555,38 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
                 DeleteObject(pen);
             };
 
-            if (!histories.cpu.empty()) {
+            // CPU x source heatmap: one column band per CPU (busiest of a group when CPUs outnumber pixels), one row per source
+            auto drawHeatmapWithLabel = [&](const IrqSample* irq, int offsetX, const char* label) {
+                SetTextColor(hdc, RGB(180, 180, 180));
+                SetBkMode(hdc, TRANSPARENT);
+                TextOutA(hdc, offsetX, PADDING_Y + GRAPH_HEIGHT + 2, label, (int) strlen(label));
+                if (!irq || irq->cpuCount <= 0)
+                    return;
+
+                int     rowHeight = GRAPH_HEIGHT / IrqSourceCount;
+                HGDIOBJ oldBrush  = SelectObject(hdc, GetStockObject(DC_BRUSH));
+                for (int src = 0; src < IrqSourceCount; ++src) {
+                    float rowMax = IRQ_HEATMAP_FLOOR[src];
+                    for (int cpu = 0; cpu < irq->cpuCount; ++cpu)
+                        rowMax = std::max(rowMax, irq->at(cpu, src));
+                    int top = PADDING_Y + src * rowHeight;
+                    for (int px = 0; px < GRAPH_WIDTH; ++px) {
+                        int   lo = px * irq->cpuCount / GRAPH_WIDTH;
+                        int   hi = std::max(lo + 1, (px + 1) * irq->cpuCount / GRAPH_WIDTH);
+                        float v  = 0.f;
+                        for (int cpu = lo; cpu < hi; ++cpu)
+                            v = std::max(v, irq->at(cpu, src));
+                        v = std::clamp(v / rowMax, 0.f, 1.f);
+                        // Dark grey (not black, which is the transparency key) -> orange
+                        SetDCBrushColor(hdc, RGB(40 + (int) (215 * v), 40 + (int) (40 * v), 40 - (int) (40 * v)));
+                        RECT cell{offsetX + px, top, offsetX + px + 1, top + rowHeight - 1};
+                        FillRect(hdc, &cell, (HBRUSH) GetStockObject(DC_BRUSH));
+                    }
+                }
+                SelectObject(hdc, oldBrush);
+            };
+
+            if (!histories.cpu.values.empty()) {
                 int column = 0;
                 if (g_showCpuGraph) {
                     drawGraphWithLabel(histories.cpu, PADDING_X + (GRAPH_WIDTH + GRAPH_SPACING) * column, RGB(0, 255, 100), "CPU");
@@ -256,6 +600,28 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
                     drawGraphWithLabel(histories.net, PADDING_X + (GRAPH_WIDTH + GRAPH_SPACING) * column, RGB(255, 200, 0), "NET");
                     column++;
                 }
+                if (g_showIrqGraph) {
+                    const IrqSample* irq = g_lastSnap.irq ? &*g_lastSnap.irq : nullptr;
+                    drawHeatmapWithLabel(irq, PADDING_X + (GRAPH_WIDTH + GRAPH_SPACING) * column, "IRQ");
+                    column++;
+                }
+                for (size_t n = 0; g_showNumaGraphs && n < histories.numaCpu.size(); ++n) {
+                    char label[16];
+                    snprintf(label, sizeof(label), "N%zu CPU", n);
+                    int x = PADDING_X + (GRAPH_WIDTH + GRAPH_SPACING) * column;
+                    drawGraphWithLabel(histories.numaCpu[n], x, RGB(0, 255, 100), label);
+                    column++;
+                    snprintf(label, sizeof(label), "N%zu MEM", n);
+                    drawGraphWithLabel(histories.numaMem[n], x + GRAPH_WIDTH + GRAPH_SPACING, RGB(100, 150, 255), label);
+                    column++;
+                }
+                for (size_t i = 0; i < histories.derived.size(); ++i) {
+                    char label[8]; // truncated to fit under the graph
+                    snprintf(label, sizeof(label), "%s", g_derived.name(g_derivedGraphs[i]).c_str());
+                    drawGraphWithLabel(histories.derived[i], PADDING_X + (GRAPH_WIDTH + GRAPH_SPACING) * column, RGB(220, 120, 255),
+                                       label);
+                    column++;
+                }
             }
             SelectObject(hdc, oldFont);
             EndPaint(hwnd, &ps);
@@ -271,6 +637,10 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
             ShowContextMenu(hwnd);
             break;
         }
+        case WM_ATTACH_EXITED: // the attached process exited; its sampler thread is ending
+            g_attachActive = false;
+            InvalidateRect(hwnd, nullptr, TRUE);
+            break;
         case WM_APP + 1: // tray icon messages
             if (lParam == WM_RBUTTONUP) {
                 ShowContextMenu(hwnd);
@@ -285,6 +655,14 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
             }
             break;
         case WM_DESTROY:
+            if (g_attachThread) {
+                SetEvent(g_attachStop);
+                WaitForSingleObject(g_attachThread, INFINITE);
+                CloseHandle(g_attachThread);
+                g_attachThread = nullptr;
+            }
+            if (g_attachStop)
+                CloseHandle(g_attachStop);
             Shell_NotifyIcon(NIM_DELETE, &g_nid);
             PostQuitMessage(0);
             break;
@@ -352,7 +730,7 @@ void PositionNearTaskbarClock() {
 }
 
 void RecomputeAndResize() {
-    int activeGraphs = (g_showCpuGraph ? 1 : 0) + (g_showMemGraph ? 1 : 0) + (g_showNetGraph ? 1 : 0);
+    int activeGraphs = ActiveGraphCount();
     int graphsWidth  = activeGraphs > 0 ? (GRAPH_WIDTH * activeGraphs) + (GRAPH_SPACING * (activeGraphs - 1)) : 0;
     int textExtra    = 300; // initial guess until frozen
     int width        = g_frozenWidth ? g_frozenWindowWidth : PADDING_X * 2 + graphsWidth + (activeGraphs > 0 ? 8 : 0) + textExtra;
@@ -416,6 +794,11 @@ void ShowContextMenu(HWND hwnd) {
     AppendMenuW(graphMenu, MF_STRING | (g_showCpuGraph ? MF_CHECKED : 0), 300, L"CPU Graph");
     AppendMenuW(graphMenu, MF_STRING | (g_showMemGraph ? MF_CHECKED : 0), 301, L"Memory Graph");
     AppendMenuW(graphMenu, MF_STRING | (g_showNetGraph ? MF_CHECKED : 0), 302, L"Network Graph");
+    AppendMenuW(graphMenu, MF_STRING | (g_showIrqGraph ? MF_CHECKED : 0), 304, L"Interrupt Heatmap");
+    AppendMenuW(graphMenu, MF_STRING | (g_showNumaGraphs ? MF_CHECKED : 0) | (histories.numaCpu.empty() ? MF_GRAYED : 0), 305,
+                L"Per-NUMA-Node Graphs");
+    AppendMenuW(graphMenu, MF_SEPARATOR, 0, nullptr);
+    AppendMenuW(graphMenu, MF_STRING | (g_graphLttb ? MF_CHECKED : 0), 303, L"Shape-preserving (LTTB)");
 
     AppendMenuW(menu, MF_POPUP, (UINT_PTR) graphMenu, L"Graphs");
     AppendMenuW(menu, MF_POPUP, (UINT_PTR) netMenu, L"Network Interface");
@@ -456,6 +839,20 @@ void ShowContextMenu(HWND hwnd) {
         g_frozenWidth  = false;
         InvalidateRect(hwnd, nullptr, FALSE);
         RecomputeAndResize();
+    } else if (cmd == 303) {
+        g_graphLttb = !g_graphLttb;
+        InvalidateRect(hwnd, nullptr, FALSE);
+    } else if (cmd == 304) {
+        g_showIrqGraph = !g_showIrqGraph;
+        g_frozenWidth  = false;
+        g_metrics.setIrqMatrixEnabled(g_showIrqGraph);
+        InvalidateRect(hwnd, nullptr, FALSE);
+        RecomputeAndResize();
+    } else if (cmd == 305) {
+        g_showNumaGraphs = !g_showNumaGraphs;
+        g_frozenWidth    = false;
+        InvalidateRect(hwnd, nullptr, FALSE);
+        RecomputeAndResize();
     }
     SaveSettings();
 
@@ -500,7 +897,38 @@ std::string BuildOverlayLine(const MetricsSnapshot& snap) {
     // Example: CPU  34% | MEM  62% | NET R: 1.2 W: 0.34 MB/s | DSK R: 12.3 W: 0.45 MB/s
     snprintf(buf, sizeof(buf), "CPU %3d%% | MEM %3d%% | NET R: %s W: %s MB/s | DSK R: %s W: %s MB/s", cpuPct, memPct, netRStr.c_str(),
              netWStr.c_str(), diskRStr.c_str(), diskWStr.c_str());
-    return buf;
+    std::string line = buf;
+    if (snap.tcp) {
+        // Example: | TCP RTX: 12/s (0.4%) RST: 3/s EST: 245 (RST counts connections reset, not RST segments)
+        snprintf(buf, sizeof(buf), " | TCP RTX: %.0f/s (%.1f%%) RST: %.0f/s EST: %u", snap.tcp->retransSegsPerSec,
+                 snap.tcp->retransRatio * 100.0f, snap.tcp->estabResetsPerSec, snap.tcp->socketsByState[TcpEstablished]);
+        line += buf;
+    }
+    if (snap.irq) {
+        snprintf(buf, sizeof(buf), " | CSW: %.0f/s", snap.irq->contextSwitchesPerSec);
+        line += buf;
+    }
+    // Derived metrics selected with [overlay] derived=; the rest only feed graphs and other metrics
+    for (int metric : g_derivedOverlay) {
+        snprintf(buf, sizeof(buf), " | %s: %.3g", g_derived.name(metric).c_str(), g_derived.value(metric));
+        line += buf;
+    }
+    if (g_attachActive) {
+        // Example: | PID 4242: CPU 135% (peak 180%) RSS 512 MB THR 64 CSW 3200/s TOP 5120 98%
+        const ThreadSample* top = nullptr;
+        for (const auto& t : g_attachSample.threads)
+            if (!top || t.cpu > top->cpu)
+                top = &t;
+        snprintf(buf, sizeof(buf), " | PID %lu: CPU %.0f%% (peak %.0f%%) RSS %s MB THR %zu CSW %.0f/s", g_attachPid,
+                 g_attachSample.cpu * 100.0f, g_attachPeakShow * 100.0f, FormatMB((double) g_attachSample.workingSetBytes, 0).c_str(),
+                 g_attachSample.threads.size(), g_attachSample.contextSwitchesPerSec);
+        line += buf;
+        if (top) {
+            snprintf(buf, sizeof(buf), " TOP %lu %.0f%%", top->tid, top->cpu * 100.0f);
+            line += buf;
+        }
+    }
+    return line;
 }
 
 int APIENTRY wWinMain(HINSTANCE hInst, HINSTANCE, LPWSTR, int) {
@@ -508,6 +936,30 @@ int APIENTRY wWinMain(HINSTANCE hInst, HINSTANCE, LPWSTR, int) {
     g_metrics.initialize();
     EnumerateNetworkInterfaces();
     LoadSettings();
+
+    int     argc = 0;
+    LPWSTR* argv = CommandLineToArgvW(GetCommandLineW(), &argc);
+    for (int i = 1; argv && i + 1 < argc; ++i) {
+        if (lstrcmpiW(argv[i], L"--attach") == 0) {
+            g_attachPid    = (unsigned long) _wtoi(argv[++i]);
+            g_attachActive = g_attach.attach(g_attachPid);
+            if (!g_attachActive) {
+                DWORD   err         = GetLastError();
+                wchar_t reason[256] = L"";
+                DWORD   len         = FormatMessageW(FORMAT_MESSAGE_FROM_SYSTEM | FORMAT_MESSAGE_IGNORE_INSERTS, nullptr, err, 0, reason,
+                                                     (DWORD) std::size(reason), nullptr);
+                while (len > 0 && (reason[len - 1] == L'\r' || reason[len - 1] == L'\n'))
+                    reason[--len] = L'\0';
+                std::wstring text = L"Cannot attach to process " + std::to_wstring(g_attachPid) + L" (error " + std::to_wstring(err) +
+                                    L"): " + reason + L"\nContinuing without attach mode.";
+                MessageBoxW(nullptr, text.c_str(), L"wtop: attach", MB_OK | MB_ICONWARNING);
+            }
+        } else if (lstrcmpiW(argv[i], L"--hz") == 0) {
+            g_attachHz = std::clamp(_wtoi(argv[++i]), 10, 100);
+        }
+    }
+    if (argv)
+        LocalFree(argv);
     WNDCLASSW wc{};
     wc.lpfnWndProc   = WndProc;
     wc.hInstance     = hInst;
@@ -2,11 +2,16 @@
 
 #include <algorithm>
 #include <chrono>
+#include <cstring>
+#include <cwchar>
 #include <iphlpapi.h>
 #include <pdh.h>
 #include <pdhmsg.h>
 #include <vector>
 #include <windows.h>
+#include <winsock2.h>
+// psapi.h relies on windows.h being included first
+#include <psapi.h>
 
 #pragma comment(lib, "iphlpapi.lib")
 #pragma comment(lib, "pdh.lib")
@@ -18,6 +23,109 @@ unsigned long long fileTimeToULL(const FILETIME& ft) {
     ui.HighPart = ft.dwHighDateTime;
     return ui.QuadPart;
 }
+
+// Calls get(buffer, &size) growing buf until the table fits; buf is kept for the next sample.
+template <typename Table, typename Get> Table* fetchTable(std::vector<unsigned char>& buf, Get&& get) {
+    for (int attempt = 0; attempt < 3; ++attempt) {
+        ULONG size = (ULONG) buf.size();
+        DWORD rc   = get(buf.empty() ? nullptr : reinterpret_cast<Table*>(buf.data()), &size);
+        if (rc == NO_ERROR && !buf.empty())
+            return reinterpret_cast<Table*>(buf.data());
+        if (rc != ERROR_INSUFFICIENT_BUFFER && rc != NO_ERROR)
+            return nullptr;
+        buf.resize(size + size / 4 + sizeof(Table)); // headroom for connections opened in between
+    }
+    return nullptr;
+}
+
+// Reads a wildcard counter into buf (grown as needed and kept for the next sample).
+PDH_FMT_COUNTERVALUE_ITEM_W* readCounterArray(void* counter, std::vector<unsigned char>& buf, DWORD& count) {
+    auto       c     = reinterpret_cast<PDH_HCOUNTER>(counter);
+    DWORD      bytes = (DWORD) buf.size();
+    auto*      items = reinterpret_cast<PDH_FMT_COUNTERVALUE_ITEM_W*>(buf.data());
+    PDH_STATUS st    = PdhGetFormattedCounterArrayW(c, PDH_FMT_DOUBLE | PDH_FMT_NOCAP100, &bytes, &count, items);
+    if (st == PDH_MORE_DATA) {
+        buf.resize(bytes);
+        items = reinterpret_cast<PDH_FMT_COUNTERVALUE_ITEM_W*>(buf.data());
+        st    = PdhGetFormattedCounterArrayW(c, PDH_FMT_DOUBLE | PDH_FMT_NOCAP100, &bytes, &count, items);
+    }
+    return st == ERROR_SUCCESS ? items : nullptr;
+}
+
+// Maps "Processor Information" instance names ("node,index", "node,_Total", "_Total") to CPU columns
+// ordered by (node, index). Returns the CPU count.
+int buildCpuLayout(const PDH_FMT_COUNTERVALUE_ITEM_W* items, DWORD count, std::vector<int>& columnOf) {
+    std::vector<std::pair<long long, DWORD>> cpus; // (node << 32 | index, item index)
+    columnOf.assign(count, -1);
+    for (DWORD i = 0; i < count; ++i) {
+        const wchar_t* name = items[i].szName;
+        if (!name || wcsstr(name, L"_Total"))
+            continue;
+        const wchar_t* comma = wcschr(name, L',');
+        long           node  = comma ? wcstol(name, nullptr, 10) : 0;
+        long           index = wcstol(comma ? comma + 1 : name, nullptr, 10);
+        cpus.push_back({((long long) node << 32) | (unsigned long) index, i});
+    }
+    std::sort(cpus.begin(), cpus.end());
+    for (size_t c = 0; c < cpus.size(); ++c)
+        columnOf[cpus[c].second] = (int) c;
+    return (int) cpus.size();
+}
+
+// Maps instance names to node numbers: "node,index" for processors, "node" for NUMA memory.
+// _Total rows and unknown nodes go to the discard slot `nodes`.
+void buildNodeLayout(const PDH_FMT_COUNTERVALUE_ITEM_W* items, DWORD count, int nodes, std::vector<int>& nodeOf) {
+    nodeOf.assign(count, nodes);
+    for (DWORD i = 0; i < count; ++i) {
+        const wchar_t* name = items[i].szName;
+        if (!name || wcschr(name, L'_'))
+            continue;
+        long node = wcstol(name, nullptr, 10);
+        if (node >= 0 && node < nodes)
+            nodeOf[i] = (int) node;
+    }
+}
+
+void countTcpState(std::array<unsigned, TcpStateCount>& counts, DWORD mibState) {
+    if (mibState >= MIB_TCP_STATE_CLOSED && mibState <= MIB_TCP_STATE_DELETE_TCB)
+        counts[mibState - MIB_TCP_STATE_CLOSED]++;
+}
+
+// Formatted value of a single-instance counter; 0 if the counter is missing or has no valid value yet.
+double readCounter(void* counter) {
+    PDH_FMT_COUNTERVALUE v{};
+    if (!counter || PdhGetFormattedCounterValue(reinterpret_cast<PDH_HCOUNTER>(counter), PDH_FMT_DOUBLE, nullptr, &v) != ERROR_SUCCESS)
+        return 0.0;
+    return v.doubleValue;
+}
+
+void removeCounters(void** counters, int count) {
+    for (int i = 0; i < count; ++i) {
+        if (counters[i])
+            PdhRemoveCounter(reinterpret_cast<PDH_HCOUNTER>(counters[i]));
+        counters[i] = nullptr;
+    }
+}
+
+// "Network Interface" instances are named after the adapter description, with the characters that are
+// reserved in counter paths replaced.
+std::wstring pdhInterfaceName(const MIB_IFROW& row) {
+    int          len = (int) strnlen(reinterpret_cast<const char*>(row.bDescr), std::min<DWORD>(row.dwDescrLen, MAXLEN_IFDESCR));
+    std::wstring name(len, L'\0');
+    name.resize(MultiByteToWideChar(CP_ACP, 0, reinterpret_cast<const char*>(row.bDescr), len, name.data(), len));
+    for (wchar_t& c : name) {
+        if (c == L'(')
+            c = L'[';
+        else if (c == L')')
+            c = L']';
+        else if (c == L'#' || c == L'/' || c == L'\\')
+            c = L'_';
+    }
+    return name;
+}
+
+// Link state and new adapters are picked up at this interval
+const unsigned long long NET_LAYOUT_REFRESH_MS = 10000;
 } // namespace
 
 MetricsCollector::MetricsCollector() {}
@@ -30,28 +138,117 @@ MetricsCollector::~MetricsCollector() {
 bool MetricsCollector::initialize() {
     lastSampleTick_ = GetTickCount64();
 
-    // Initialize disk PDH counters (best-effort)
+    // One query for all PDH sources (best-effort)
     PDH_HQUERY q = nullptr;
-    if (PdhOpenQuery(nullptr, 0, &q) == ERROR_SUCCESS) {
-        PDH_HCOUNTER cRead = nullptr, cWrite = nullptr;
-        // Use explicit wide-char PDH functions to avoid ANSI mismatch.
-        if (PdhAddCounterW(q, L"\\PhysicalDisk(_Total)\\Disk Read Bytes/sec", 0, &cRead) == ERROR_SUCCESS &&
-            PdhAddCounterW(q, L"\\PhysicalDisk(_Total)\\Disk Write Bytes/sec", 0, &cWrite) == ERROR_SUCCESS) {
-            if (PdhCollectQueryData(q) == ERROR_SUCCESS) {
-                pdhQuery_        = q;
-                pdhReadCounter_  = cRead;
-                pdhWriteCounter_ = cWrite;
-                diskInitialized_ = true;
+    if (PdhOpenQuery(nullptr, 0, &q) == ERROR_SUCCESS)
+        pdhQuery_ = q;
+
+    // Disk counters
+    void* cRead  = addPdhCounter(L"\\PhysicalDisk(_Total)\\Disk Read Bytes/sec");
+    void* cWrite = addPdhCounter(L"\\PhysicalDisk(_Total)\\Disk Write Bytes/sec");
+    if (cRead && cWrite) {
+        pdhReadCounter_      = cRead;
+        pdhWriteCounter_     = cWrite;
+        pdhTransfersCounter_ = addPdhCounter(L"\\PhysicalDisk(_Total)\\Disk Transfers/sec");
+        diskInitialized_     = true;
+    }
+
+    // Network and TCP/UDP rates; without a complete set those sources stay on the IP Helper calls
+    if (!serialNetTcp_) {
+        netCounters_[NetRecv]      = addPdhCounter(L"\\Network Interface(*)\\Bytes Received/sec");
+        netCounters_[NetSent]      = addPdhCounter(L"\\Network Interface(*)\\Bytes Sent/sec");
+        netCounters_[NetBandwidth] = addPdhCounter(L"\\Network Interface(*)\\Current Bandwidth");
+        netPdhReady_               = netCounters_[NetRecv] && netCounters_[NetSent] && netCounters_[NetBandwidth];
+        if (!netPdhReady_)
+            removeCounters(netCounters_, NetCounterCount);
+
+        const wchar_t* tcpPaths[2][TcpPdhCount] = {
+            {L"\\TCPv4\\Segments Retransmitted/sec", L"\\TCPv4\\Segments Sent/sec", L"\\TCPv4\\Connections Reset",
+             L"\\TCPv4\\Connection Failures", L"\\TCPv4\\Connections Established", L"\\UDPv4\\Datagrams Received Errors"},
+            {L"\\TCPv6\\Segments Retransmitted/sec", L"\\TCPv6\\Segments Sent/sec", L"\\TCPv6\\Connections Reset",
+             L"\\TCPv6\\Connection Failures", L"\\TCPv6\\Connections Established", L"\\UDPv6\\Datagrams Received Errors"},
+        };
+        for (int f = 0; f < 2; ++f) {
+            bool complete = true;
+            for (int c = 0; c < TcpPdhCount; ++c) {
+                tcpCounters_[f][c] = addPdhCounter(tcpPaths[f][c]);
+                complete           = complete && tcpCounters_[f][c];
             }
+            if (!complete)
+                removeCounters(tcpCounters_[f], TcpPdhCount); // IPv6 may be disabled; IPv4 decides below
+            if (f == 0)
+                tcpPdhReady_ = complete;
         }
-        if (!diskInitialized_) {
-            if (q)
-                PdhCloseQuery(q);
-        }
+        if (!tcpPdhReady_)
+            removeCounters(tcpCounters_[1], TcpPdhCount);
+    }
+
+    // NUMA topology; counters are only registered on multi-node systems
+    ULONG highestNode = 0;
+    if (GetNumaHighestNodeNumber(&highestNode) && highestNode > 0) {
+        numaNodes_          = (int) highestNode + 1;
+        numaCpuCounter_     = addPdhCounter(L"\\Processor Information(*)\\% Processor Time");
+        numaMemCounters_[0] = addPdhCounter(L"\\NUMA Node Memory(*)\\Total MBytes");
+        numaMemCounters_[1] = addPdhCounter(L"\\NUMA Node Memory(*)\\Available MBytes");
+        numaMemCounters_[2] = addPdhCounter(L"\\NUMA Node Memory(*)\\Standby List MBytes");
+        numaSums_.assign((size_t) numaNodes_ + 1, 0.0);
+        numaNodeCpus_.assign((size_t) numaNodes_ + 1, 0);
     }
+
+    // The per-CPU interrupt matrix is registered by setIrqMatrixEnabled(); the context switch rate is one cheap counter
+    ctxSwitchCounter_ = addPdhCounter(L"\\System\\Context Switches/sec");
+    updateIrqCounters();
+
+    // Prime rate counters so the first sample() has a baseline
+    collectPdh();
     return true;
 }
 
+void* MetricsCollector::addPdhCounter(const wchar_t* path) {
+    if (!pdhQuery_)
+        return nullptr;
+    PDH_HCOUNTER c = nullptr;
+    // Use explicit wide-char PDH functions to avoid ANSI mismatch.
+    if (PdhAddCounterW(reinterpret_cast<PDH_HQUERY>(pdhQuery_), path, 0, &c) != ERROR_SUCCESS)
+        return nullptr;
+    return c;
+}
+
+void MetricsCollector::setIrqMatrixEnabled(bool enabled) {
+    irqMatrixEnabled_ = enabled;
+    updateIrqCounters();
+}
+
+// Adds or removes the wildcard interrupt counters so that PdhCollectQueryData only pays for them while wanted.
+void MetricsCollector::updateIrqCounters() {
+    if (!pdhQuery_ || irqMatrixEnabled_ == irqInitialized_)
+        return;
+    if (irqMatrixEnabled_) {
+        // "Processor Information" covers processor groups beyond 64 CPUs
+        const wchar_t* irqPaths[IrqSourceCount] = {
+            L"\\Processor Information(*)\\Interrupts/sec",
+            L"\\Processor Information(*)\\DPCs Queued/sec",
+            L"\\Processor Information(*)\\% Interrupt Time",
+            L"\\Processor Information(*)\\% DPC Time",
+        };
+        irqInitialized_ = true;
+        for (int s = 0; s < IrqSourceCount; ++s) {
+            irqCounters_[s] = addPdhCounter(irqPaths[s]);
+            irqInitialized_ = irqInitialized_ && irqCounters_[s];
+        }
+        if (irqInitialized_)
+            return;
+    }
+    removeCounters(irqCounters_, IrqSourceCount);
+    irqInitialized_ = false;
+    irqColumnOf_.clear(); // rebuilt from the first read after re-registering
+}
+
+bool MetricsCollector::collectPdh() {
+    pdhCollected_ = pdhQuery_ && PdhCollectQueryData(reinterpret_cast<PDH_HQUERY>(pdhQuery_)) == ERROR_SUCCESS;
+    return pdhCollected_;
+}
+
 CpuSample MetricsCollector::sampleCpu() {
     FILETIME idle, kernel, user;
     if (!GetSystemTimes(&idle, &kernel, &user))
@@ -88,21 +285,94 @@ MemorySample MetricsCollector::sampleMemory() {
     MEMORYSTATUSEX ms{sizeof(ms)};
     MemorySample   m;
     if (GlobalMemoryStatusEx(&ms)) {
-        m.usage = (float) (ms.ullTotalPhys - ms.ullAvailPhys) / (float) ms.ullTotalPhys;
+        m.usage      = (float) (ms.ullTotalPhys - ms.ullAvailPhys) / (float) ms.ullTotalPhys;
+        m.totalBytes = (double) ms.ullTotalPhys;
+        m.availBytes = (double) ms.ullAvailPhys;
     }
+    PERFORMANCE_INFORMATION pi{};
+    pi.cb = sizeof(pi);
+    if (GetPerformanceInfo(&pi, sizeof(pi)))
+        m.cacheBytes = (double) pi.SystemCache * (double) pi.PageSize;
     return m;
 }
 
 std::optional<NetSample> MetricsCollector::sampleNet() {
-    ULONG size = 0;
-    if (GetIfTable(nullptr, &size, FALSE) != ERROR_INSUFFICIENT_BUFFER) {
+    if (netPdhReady_ && pdhCollected_) {
+        if (auto ns = sampleNetPdh()) {
+            netInitialized_ = false; // the serial path re-primes if it has to take over
+            return ns;
+        }
+    }
+    return sampleNetSerial();
+}
+
+std::optional<NetSample> MetricsCollector::sampleNetPdh() {
+    DWORD count = 0;
+    auto* items = readCounterArray(netCounters_[NetBandwidth], pdhArrayBuf_, count);
+    if (!items)
         return std::nullopt;
+    if (count != netInstanceIf_.size() || GetTickCount64() - netLayoutTick_ >= NET_LAYOUT_REFRESH_MS)
+        buildNetLayout(items, count);
+    if (!netMatched_)
+        return std::nullopt; // no instance name matched an adapter description
+
+    // Same choice as the serial path: the fastest eligible interface, or the one picked in the menu
+    long   selected  = -1;
+    double bandwidth = 0.0;
+    for (DWORD i = 0; i < count; ++i) {
+        long ifIndex = netInstanceIf_[i];
+        if (ifIndex < 0 || items[i].FmtValue.CStatus != ERROR_SUCCESS)
+            continue;
+        double speed = items[i].FmtValue.doubleValue;
+        if (selectedNetInterface_ == -1 ? (selected < 0 || speed > bandwidth) : ifIndex == selectedNetInterface_) {
+            selected  = (long) i;
+            bandwidth = speed;
+        }
     }
-    std::vector<unsigned char> buf(size);
-    PMIB_IFTABLE               table = (PMIB_IFTABLE) buf.data();
-    if (GetIfTable(table, &size, FALSE) != NO_ERROR) {
+    if (selected < 0)
         return std::nullopt;
+
+    NetSample ns;
+    ns.linkSpeedBitsPerSec = (unsigned long) std::min(bandwidth, 4294967295.0);
+    double* rates[2]       = {&ns.bytesRecvPerSec, &ns.bytesSentPerSec}; // NetRecv, NetSent
+    for (int c = NetRecv; c <= NetSent; ++c) {
+        items = readCounterArray(netCounters_[c], pdhArrayBuf_, count);
+        if (!items || count != netInstanceIf_.size())
+            return std::nullopt;
+        if (items[selected].FmtValue.CStatus == ERROR_SUCCESS)
+            *rates[c] = items[selected].FmtValue.doubleValue;
     }
+    return ns;
+}
+
+// Maps each PDH instance to the interface index of an operational, non-loopback adapter with the same name.
+void MetricsCollector::buildNetLayout(const void* pdhItems, unsigned long count) {
+    auto* items    = static_cast<const PDH_FMT_COUNTERVALUE_ITEM_W*>(pdhItems);
+    netLayoutTick_ = GetTickCount64();
+    netMatched_    = 0;
+    netInstanceIf_.assign(count, -1);
+    auto* table = fetchTable<MIB_IFTABLE>(ifTableBuf_, [](MIB_IFTABLE* p, ULONG* size) { return GetIfTable(p, size, FALSE); });
+    if (!table)
+        return;
+    for (DWORD r = 0; r < table->dwNumEntries; ++r) {
+        const MIB_IFROW& row = table->table[r];
+        if (row.dwOperStatus != IF_OPER_STATUS_OPERATIONAL || row.dwType == IF_TYPE_SOFTWARE_LOOPBACK)
+            continue;
+        std::wstring name = pdhInterfaceName(row);
+        for (DWORD i = 0; i < count; ++i) {
+            if (netInstanceIf_[i] < 0 && items[i].szName && name == items[i].szName) {
+                netInstanceIf_[i] = (long) row.dwIndex;
+                netMatched_++;
+                break;
+            }
+        }
+    }
+}
+
+std::optional<NetSample> MetricsCollector::sampleNetSerial() {
+    auto* table = fetchTable<MIB_IFTABLE>(ifTableBuf_, [](MIB_IFTABLE* p, ULONG* size) { return GetIfTable(p, size, FALSE); });
+    if (!table)
+        return std::nullopt;
 
     PMIB_IFROW selected = nullptr;
 
@@ -162,12 +432,8 @@ std::optional<NetSample> MetricsCollector::sampleNet() {
 }
 
 std::optional<DiskSample> MetricsCollector::sampleDisk() {
-    if (!diskInitialized_)
+    if (!diskInitialized_ || !pdhCollected_)
         return std::nullopt;
-    auto nowTick = GetTickCount64();
-    if (PdhCollectQueryData(reinterpret_cast<PDH_HQUERY>(pdhQuery_)) != ERROR_SUCCESS) {
-        return std::nullopt;
-    }
 
     PDH_FMT_COUNTERVALUE vRead{};
     DWORD                typeRead = 0;
@@ -181,15 +447,200 @@ std::optional<DiskSample> MetricsCollector::sampleDisk() {
     double readB  = (double) vRead.largeValue;
     double writeB = (double) vWrite.largeValue;
 
-    return DiskSample{readB, writeB};
+    // Operation count is optional; bytes still report if the counter is missing
+    double               transfers = 0.0;
+    PDH_FMT_COUNTERVALUE vTransfers{};
+    if (pdhTransfersCounter_ && PdhGetFormattedCounterValue(reinterpret_cast<PDH_HCOUNTER>(pdhTransfersCounter_), PDH_FMT_DOUBLE,
+                                                            nullptr, &vTransfers) == ERROR_SUCCESS)
+        transfers = vTransfers.doubleValue;
+
+    return DiskSample{readB, writeB, transfers};
+}
+
+std::optional<TcpSample> MetricsCollector::sampleTcp() {
+    bool        viaPdh = tcpPdhReady_ && pdhCollected_;
+    TcpCounters cur{};
+    TcpSample   t;
+    if (viaPdh) {
+        // Segment rates come straight from the counters; the connection and UDP totals are differenced below
+        double retrans = 0.0;
+        double sent    = 0.0;
+        for (auto& family : tcpCounters_) {
+            retrans += readCounter(family[TcpPdhRetrans]);
+            sent += readCounter(family[TcpPdhSent]);
+            cur.estabResets += (unsigned long) readCounter(family[TcpPdhResets]);
+            cur.attemptFails += (unsigned long) readCounter(family[TcpPdhFailures]);
+            cur.currEstab += (unsigned long) readCounter(family[TcpPdhEstablished]);
+            cur.udpInErrors += (unsigned long) readCounter(family[TcpPdhUdpErrors]);
+        }
+        t.retransSegsPerSec = retrans;
+        if (sent > 0.0)
+            t.retransRatio = std::min(1.0f, (float) (retrans / sent));
+    }
+    // Without PDH the IP Helper statistics are the whole source; with it they are only needed for the RST segment
+    // and input error counts, which have no counter
+    if (!viaPdh || tcpDetail_) {
+        bool haveStats = false;
+        for (ULONG family : {(ULONG) AF_INET, (ULONG) AF_INET6}) {
+            MIB_TCPSTATS ts{};
+            if (GetTcpStatisticsEx(&ts, family) == NO_ERROR) {
+                cur.outRsts += ts.dwOutRsts;
+                cur.inErrs += ts.dwInErrs;
+                if (!viaPdh) {
+                    cur.retransSegs += ts.dwRetransSegs;
+                    cur.outSegs += ts.dwOutSegs;
+                    cur.estabResets += ts.dwEstabResets;
+                    cur.attemptFails += ts.dwAttemptFails;
+                    cur.currEstab += ts.dwCurrEstab;
+                }
+                haveStats = true;
+            }
+            MIB_UDPSTATS us{};
+            if (!viaPdh && GetUdpStatisticsEx(&us, family) == NO_ERROR)
+                cur.udpInErrors += us.dwInErrors;
+        }
+        if (!haveStats && !viaPdh)
+            return std::nullopt;
+    }
+
+    // Totals from different sources do not difference against each other
+    int mode = (viaPdh ? 1 : 0) | (tcpDetail_ ? 2 : 0);
+    if (mode != tcpMode_)
+        tcpInitialized_ = false;
+    tcpMode_ = mode;
+
+    auto nowTick = GetTickCount64();
+    if (tcpInitialized_) {
+        double seconds = nowTick > prevTcpTick_ ? (double) (nowTick - prevTcpTick_) / 1000.0 : 1.0;
+        // MIB counters are 32-bit; unsigned subtraction handles a single wrap.
+        auto rate            = [&](unsigned long now, unsigned long prev) { return (double) (DWORD) (now - prev) / seconds; };
+        t.outResetsPerSec    = rate(cur.outRsts, prevTcp_.outRsts);
+        t.estabResetsPerSec  = rate(cur.estabResets, prevTcp_.estabResets);
+        t.attemptFailsPerSec = rate(cur.attemptFails, prevTcp_.attemptFails);
+        t.inErrorsPerSec     = rate(cur.inErrs, prevTcp_.inErrs);
+        t.udpInErrorsPerSec  = rate(cur.udpInErrors, prevTcp_.udpInErrors);
+        if (!viaPdh) {
+            DWORD sent          = (DWORD) (cur.outSegs - prevTcp_.outSegs);
+            t.retransSegsPerSec = rate(cur.retransSegs, prevTcp_.retransSegs);
+            if (sent > 0)
+                t.retransRatio = std::min(1.0f, (float) (DWORD) (cur.retransSegs - prevTcp_.retransSegs) / (float) sent);
+        }
+    }
+    prevTcp_        = cur;
+    prevTcpTick_    = nowTick;
+    tcpInitialized_ = true;
+
+    if (!tcpDetail_) {
+        t.socketsByState[TcpEstablished] = cur.currEstab;
+        return t;
+    }
+    // Per-state socket counts (best-effort; rates above are still reported if the tables fail)
+    if (auto* table = fetchTable<MIB_TCPTABLE>(tcpTableBuf_, [](MIB_TCPTABLE* p, ULONG* size) { return GetTcpTable(p, size, FALSE); })) {
+        for (DWORD i = 0; i < table->dwNumEntries; ++i)
+            countTcpState(t.socketsByState, table->table[i].dwState);
+    }
+    auto getTcp6Table = [](MIB_TCP6TABLE* p, ULONG* size) { return GetTcp6Table(p, size, FALSE); };
+    if (auto* table6 = fetchTable<MIB_TCP6TABLE>(tcpTableBuf_, getTcp6Table)) {
+        for (DWORD i = 0; i < table6->dwNumEntries; ++i)
+            countTcpState(t.socketsByState, (DWORD) table6->table[i].State);
+    }
+    return t;
+}
+
+std::optional<IrqSample> MetricsCollector::sampleIrq() {
+    if ((!irqInitialized_ && !ctxSwitchCounter_) || !pdhCollected_)
+        return std::nullopt;
+
+    // The matrix stays empty unless the heatmap asked for it, or on the first tick after it did (no rate baseline yet)
+    IrqSample s;
+    for (int src = 0; irqInitialized_ && src < IrqSourceCount; ++src) {
+        DWORD count = 0;
+        auto* items = readCounterArray(irqCounters_[src], pdhArrayBuf_, count);
+        if (!items) {
+            s.cpuCount = 0;
+            s.matrix.clear();
+            break;
+        }
+
+        if (count != irqColumnOf_.size())
+            irqCpuCount_ = buildCpuLayout(items, count, irqColumnOf_);
+        if (s.matrix.empty()) {
+            s.cpuCount = irqCpuCount_;
+            s.matrix.assign((size_t) s.cpuCount * IrqSourceCount, 0.0f);
+        }
+        for (DWORD i = 0; i < count; ++i) {
+            int col = irqColumnOf_[i];
+            if (col >= 0 && col < s.cpuCount && items[i].FmtValue.CStatus == ERROR_SUCCESS)
+                s.matrix[(size_t) col * IrqSourceCount + src] = (float) items[i].FmtValue.doubleValue;
+        }
+    }
+
+    PDH_FMT_COUNTERVALUE v{};
+    if (ctxSwitchCounter_ &&
+        PdhGetFormattedCounterValue(reinterpret_cast<PDH_HCOUNTER>(ctxSwitchCounter_), PDH_FMT_DOUBLE, nullptr, &v) == ERROR_SUCCESS)
+        s.contextSwitchesPerSec = v.doubleValue;
+    return s;
+}
+
+std::vector<NumaNodeSample> MetricsCollector::sampleNuma() {
+    std::vector<NumaNodeSample> nodes;
+    if (numaNodes_ < 2 || !numaCpuCounter_ || !pdhCollected_)
+        return nodes;
+
+    DWORD count = 0;
+    auto* items = readCounterArray(numaCpuCounter_, pdhArrayBuf_, count);
+    if (!items)
+        return nodes;
+    if (count != numaNodeOf_.size())
+        buildNodeLayout(items, count, numaNodes_, numaNodeOf_);
+    // CPU -> node reduction; _Total rows and rows PDH could not format land in the discard slot, so the loop
+    // has no branches and a CPU only counts towards its node's average when it has a value
+    std::fill(numaSums_.begin(), numaSums_.end(), 0.0);
+    std::fill(numaNodeCpus_.begin(), numaNodeCpus_.end(), 0);
+    for (DWORD i = 0; i < count; ++i) {
+        int slot = items[i].FmtValue.CStatus == ERROR_SUCCESS ? numaNodeOf_[i] : numaNodes_;
+        numaSums_[slot] += items[i].FmtValue.doubleValue;
+        numaNodeCpus_[slot]++;
+    }
+
+    nodes.resize(numaNodes_);
+    for (int n = 0; n < numaNodes_; ++n) {
+        if (numaNodeCpus_[n] > 0)
+            nodes[n].cpuUsage = std::clamp((float) (numaSums_[n] / numaNodeCpus_[n] / 100.0), 0.0f, 1.0f);
+    }
+
+    // Per-node memory (the NUMA Node Memory set is missing on older systems; CPU figures still apply)
+    for (int m = 0; m < 3 && numaMemCounters_[m]; ++m) {
+        items = readCounterArray(numaMemCounters_[m], pdhArrayBuf_, count);
+        if (!items)
+            break;
+        if (count != numaMemNodeOf_.size())
+            buildNodeLayout(items, count, numaNodes_, numaMemNodeOf_);
+        for (DWORD i = 0; i < count; ++i) {
+            int n = numaMemNodeOf_[i];
+            if (n >= numaNodes_ || items[i].FmtValue.CStatus != ERROR_SUCCESS)
+                continue;
+            double bytes = items[i].FmtValue.doubleValue * 1024.0 * 1024.0;
+            (m == 0 ? nodes[n].totalBytes : m == 1 ? nodes[n].availBytes : nodes[n].fileBytes) = bytes;
+        }
+    }
+    for (auto& node : nodes) {
+        if (node.totalBytes > 0.0)
+            node.memUsage = std::clamp((float) ((node.totalBytes - node.availBytes) / node.totalBytes), 0.0f, 1.0f);
+    }
+    return nodes;
 }
 
 MetricsSnapshot MetricsCollector::sample() {
     MetricsSnapshot snap;
+    collectPdh(); // refresh every PDH-backed source at once
     snap.cpu    = sampleCpu();
     snap.memory = sampleMemory();
     snap.net    = sampleNet();
     snap.disk   = sampleDisk();
+    snap.tcp    = sampleTcp();
+    snap.irq    = sampleIrq();
+    snap.numa   = sampleNuma();
     return snap;
 }
 
@@ -199,3 +650,11 @@ void MetricsCollector::setSelectedNetworkInterface(int interfaceIndex) {
         netInitialized_       = false; // Reset to reinitialize counters
     }
 }
+
+void MetricsCollector::setTcpDetailEnabled(bool enabled) {
+    tcpDetail_ = enabled;
+}
+
+void MetricsCollector::setSerialNetTcp(bool serial) {
+    serialNetTcp_ = serial;
+}
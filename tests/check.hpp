@@ -0,0 +1,20 @@
+// Minimal check harness shared by the unit tests: CHECK counts failures, main returns reportChecks().
+#pragma once
+#include <cstdio>
+
+inline int g_failures = 0;
+
+#define CHECK(cond)                                                                                                    \
+    do {                                                                                                               \
+        if (!(cond)) {                                                                                                 \
+            std::printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond);                                       \
+            g_failures++;                                                                                              \
+        }                                                                                                              \
+    } while (0)
+
+// Prints the failure count, if any, and returns the process exit code.
+inline int reportChecks() {
+    if (g_failures)
+        std::printf("%d check(s) failed\n", g_failures);
+    return g_failures ? 1 : 0;
+}
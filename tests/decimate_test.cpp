@@ -0,0 +1,219 @@
+// Checks the decimation kernels against plain scalar references and reports their throughput.
+#include "check.hpp"
+#include "decimate.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+// Logical (oldest..newest) copy of the ring, built independently of makeRingView.
+static std::vector<float> linearize(const std::vector<float>& buf, size_t nextIndex, size_t filled) {
+    std::vector<float> out;
+    size_t             cap = buf.size();
+    for (size_t i = 0; i < filled; ++i)
+        out.push_back(buf[(nextIndex + cap - filled + i) % cap]);
+    return out;
+}
+
+static std::vector<EnvelopeColumn> referenceMinMax(const std::vector<float>& v, int columns) {
+    std::vector<EnvelopeColumn> out;
+    size_t                      n    = v.size();
+    size_t                      cols = std::min(n, (size_t) columns);
+    for (size_t c = 0; c < cols; ++c) {
+        auto first = v.begin() + (long) (c * n / cols);
+        auto last  = v.begin() + (long) ((c + 1) * n / cols);
+        out.push_back({*std::min_element(first, last), *std::max_element(first, last)});
+    }
+    return out;
+}
+
+// Textbook LTTB: same bucket boundaries, but each candidate's area comes straight from the triangle formula.
+static std::vector<size_t> referenceLttb(const std::vector<float>& v, int threshold) {
+    size_t              n = v.size();
+    std::vector<size_t> out{0};
+    double              every = (double) (n - 2) / (double) (threshold - 2);
+    size_t              a     = 0;
+    for (int i = 0; i < threshold - 2; ++i) {
+        size_t avgStart = (size_t) std::floor((i + 1) * every) + 1;
+        size_t avgEnd   = std::min((size_t) std::floor((i + 2) * every) + 1, n);
+        double cx       = 0.0; // centroid of the next bucket
+        double cy       = 0.0;
+        for (size_t j = avgStart; j < avgEnd; ++j) {
+            cx += (double) j;
+            cy += v[j];
+        }
+        cx /= (double) (avgEnd - avgStart);
+        cy /= (double) (avgEnd - avgStart);
+
+        double ax       = (double) a;
+        double ay       = v[a];
+        double maxArea  = -1.0;
+        size_t maxIndex = 0;
+        for (size_t j = (size_t) std::floor(i * every) + 1; j < (size_t) std::floor((i + 1) * every) + 1; ++j) {
+            double bx   = (double) j;
+            double by   = v[j];
+            double area = 0.5 * std::fabs(ax * (by - cy) + bx * (cy - ay) + cx * (ay - by));
+            if (area > maxArea) {
+                maxArea  = area;
+                maxIndex = j;
+            }
+        }
+        out.push_back(maxIndex);
+        a = maxIndex;
+    }
+    out.push_back(n - 1);
+    return out;
+}
+
+// Integer-valued samples keep every partial sum exact, so the SIMD and scalar paths must agree bit for bit.
+static std::vector<float> makeBuffer(size_t n, unsigned seed) {
+    std::mt19937                       rng(seed);
+    std::uniform_int_distribution<int> dist(0, 1000);
+    std::vector<float>                 buf(n);
+    for (float& f : buf)
+        f = (float) dist(rng);
+    return buf;
+}
+
+static void testDecimate(size_t cap, size_t nextIndex, size_t filled) {
+    std::vector<float> buf    = makeBuffer(cap, (unsigned) (cap * 31 + nextIndex * 7 + filled));
+    RingView           view   = makeRingView(buf, nextIndex, filled);
+    std::vector<float> linear = linearize(buf, nextIndex, filled);
+    CHECK(view.size() == linear.size());
+    for (size_t i = 0; i < linear.size(); ++i)
+        CHECK(view[i] == linear[i]);
+
+    for (int columns : {1, 7, 60, 333, (int) cap + 5}) {
+        std::vector<EnvelopeColumn> out(columns);
+        std::vector<EnvelopeColumn> ref = referenceMinMax(linear, columns);
+        CHECK(decimateMinMax(view, out.data(), columns) == (int) ref.size());
+        for (size_t c = 0; c < ref.size(); ++c)
+            CHECK(out[c].min == ref[c].min && out[c].max == ref[c].max);
+    }
+    // Noisy data has near-ties between candidates, so only the shape of the output is checked here;
+    // testLttbPicksPeaks compares the chosen indices.
+    for (int threshold : {1, 2, 3, 10, 60, 250, (int) cap + 5}) {
+        std::vector<DecimatedPoint> out(threshold);
+        int                         n = decimateLttb(view, out.data(), threshold);
+        if ((size_t) threshold >= filled || threshold < 3) {
+            CHECK(n == (int) std::min(filled, (size_t) threshold)); // too few samples to reduce: passed through
+        } else {
+            CHECK(n == threshold);
+            CHECK(out[0].x == 0.0f && out[n - 1].x == (float) (filled - 1));
+        }
+        for (int i = 0; i < n; ++i) {
+            CHECK(i == 0 || out[i].x > out[i - 1].x);
+            CHECK(out[i].y == linear[(size_t) out[i].x]);
+        }
+    }
+}
+
+// One spike per bucket, alternating up and down, on a low noisy baseline: each spike is the clear
+// largest triangle of its bucket, so decimateLttb and the reference must both pick exactly the spikes.
+static void testLttbPicksPeaks(size_t cap, size_t nextIndex, size_t filled, int threshold) {
+    std::mt19937        rng((unsigned) (filled * 13 + (size_t) threshold));
+    std::vector<float>  linear(filled);
+    std::vector<size_t> expected{0};
+    for (size_t j = 1; j + 1 < filled; ++j)
+        linear[j] = (float) (rng() % 11);
+    double every = (double) (filled - 2) / (double) (threshold - 2);
+    for (int i = 0; i < threshold - 2; ++i) {
+        size_t first  = (size_t) std::floor(i * every) + 1;
+        size_t last   = (size_t) std::floor((i + 1) * every) + 1;
+        size_t spike  = first + rng() % (last - first);
+        linear[spike] = (i % 2 ? -10000.0f : 10000.0f) - (float) i;
+        expected.push_back(spike);
+    }
+    expected.push_back(filled - 1);
+
+    std::vector<float> buf(cap, 0.0f);
+    for (size_t i = 0; i < filled; ++i)
+        buf[(nextIndex + cap - filled + i) % cap] = linear[i];
+    CHECK(referenceLttb(linear, threshold) == expected);
+
+    std::vector<DecimatedPoint> out(threshold);
+    CHECK(decimateLttb(makeRingView(buf, nextIndex, filled), out.data(), threshold) == threshold);
+    for (int i = 0; i < threshold; ++i)
+        CHECK(out[i].x == (float) expected[i] && out[i].y == linear[expected[i]]);
+}
+
+static void testEnvelopeEviction() {
+    const int      columns = 4, perColumn = 3;
+    MinMaxEnvelope env;
+    env.reset(columns, perColumn);
+    std::vector<float> pushed;
+    EnvelopeColumn     out[columns + 2];
+    CHECK(env.read(out, columns) == 0);
+    for (int i = 0; i < 40; ++i) {
+        float v = (float) ((i * 37) % 11) - 5.0f;
+        env.push(v);
+        pushed.push_back(v);
+
+        // Expected: the newest `columns` buckets of the absolute sample stream, the last one possibly partial.
+        size_t buckets = (pushed.size() + perColumn - 1) / perColumn;
+        size_t count   = std::min(buckets, (size_t) columns);
+        CHECK(env.read(out, columns + 2) == (int) count);
+        for (size_t c = 0; c < count; ++c) {
+            size_t b     = buckets - count + c;
+            auto   first = pushed.begin() + (long) (b * perColumn);
+            auto   last  = pushed.begin() + (long) std::min(pushed.size(), (b + 1) * perColumn);
+            CHECK(out[c].min == *std::min_element(first, last));
+            CHECK(out[c].max == *std::max_element(first, last));
+        }
+    }
+    CHECK(env.read(out, 2) == 2); // truncated reads keep the oldest columns of the window
+    env.reset(columns, perColumn);
+    CHECK(env.read(out, columns) == 0);
+}
+
+static void reportThroughput(size_t cap, int columns, int iterations) {
+    std::vector<float>          buf  = makeBuffer(cap, 1);
+    RingView                    view = makeRingView(buf, cap / 3, cap);
+    std::vector<EnvelopeColumn> env(columns);
+    std::vector<DecimatedPoint> pts(columns);
+    volatile float              sink = 0.0f;
+
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        decimateMinMax(view, env.data(), columns);
+        sink = sink + env[0].max;
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        decimateLttb(view, pts.data(), columns);
+        sink = sink + pts[1].y;
+    }
+    auto   t2      = std::chrono::steady_clock::now();
+    double samples = (double) cap * iterations;
+    std::printf("%8zu samples -> %3d columns: minmax %7.0f Msamples/s, lttb %7.0f Msamples/s\n", cap, columns,
+                samples / std::chrono::duration<double>(t1 - t0).count() / 1e6,
+                samples / std::chrono::duration<double>(t2 - t1).count() / 1e6);
+}
+
+int main() {
+    testDecimate(600, 0, 600);   // full, unwrapped
+    testDecimate(600, 217, 600); // full, wrapped
+    testDecimate(600, 250, 250); // partial, unwrapped
+    testDecimate(600, 100, 420); // partial, wrapped
+    testDecimate(600, 599, 1);
+    testDecimate(1000, 3, 999);
+    {
+        std::vector<float> empty;
+        CHECK(makeRingView(empty, 0, 0).size() == 0);
+        EnvelopeColumn col;
+        CHECK(decimateMinMax(RingView{}, &col, 1) == 0);
+    }
+    testLttbPicksPeaks(600, 217, 600, 60); // wrapped, 10 samples per bucket
+    testLttbPicksPeaks(600, 100, 420, 250);
+    testLttbPicksPeaks(1000, 3, 999, 3);
+    testLttbPicksPeaks(600, 0, 600, 598); // mostly single-sample buckets
+    testEnvelopeEviction();
+
+    reportThroughput(600, 60, 20000);
+    reportThroughput(1 << 20, 1000, 20);
+
+    return reportChecks();
+}
@@ -0,0 +1,65 @@
+// Checks expression compilation, evaluation and error reporting of derived metrics.
+#include "check.hpp"
+#include "derived.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <string>
+
+static bool near(double a, double b) {
+    return std::fabs(a - b) <= 1e-9 * std::max(1.0, std::fabs(b));
+}
+
+static void testEvaluate() {
+    DerivedMetrics m({"a", "b"});
+    CHECK(m.add("sum", "a + b * 2"));
+    CHECK(m.add("neg", "-(a - b) / 4"));
+    CHECK(m.add("clamped", "clamp(sum, 0, 10) + min(a, b) - max(a, b) + abs(-a)"));
+    CHECK(m.add("div0", "a / (b - b)"));
+    CHECK(m.add("r", "rate(a)"));
+    CHECK(m.add("avg", "ewma(a, 0.5)"));
+    CHECK(m.find("avg") == 5 && m.find("a") == -1 && m.count() == 6);
+    CHECK(m.usesInput(0) && m.usesInput(1));
+    DerivedMetrics onlyB({"a", "b"});
+    CHECK(onlyB.add("twice", "b * 2") && onlyB.add("again", "twice + 1"));
+    CHECK(!onlyB.usesInput(0) && onlyB.usesInput(1));
+
+    double in[2] = {3.0, 5.0};
+    m.evaluate(in, 1.0);
+    CHECK(near(m.value(0), 13.0));
+    CHECK(near(m.value(1), 0.5));
+    CHECK(near(m.value(2), 10.0 + 3.0 - 5.0 + 3.0));
+    CHECK(m.value(3) == 0.0);
+    CHECK(m.value(4) == 0.0); // no history yet
+    CHECK(near(m.value(5), 3.0));
+
+    in[0] = 7.0;
+    m.evaluate(in, 0.5);
+    CHECK(near(m.value(4), 8.0));
+    CHECK(near(m.value(5), 5.0));
+}
+
+static void testErrors() {
+    DerivedMetrics m({"a"});
+    std::string    err;
+    CHECK(!m.add("x", "a +", &err) && !err.empty());
+    CHECK(!m.add("x", "nope", &err) && err.find("unknown name") != std::string::npos);
+    CHECK(!m.add("x", "min(a)", &err) && err.find("argument") != std::string::npos);
+    CHECK(!m.add("1x", "a", &err) && err.find("invalid name") != std::string::npos);
+    CHECK(!m.add("a", "1", &err) && err.find("already defined") != std::string::npos);
+    CHECK(m.count() == 0);
+
+    // Deep nesting must fail cleanly instead of overflowing the stack.
+    std::string deep = std::string(30000, '(') + "a" + std::string(30000, ')');
+    CHECK(!m.add("x", deep, &err) && err.find("nested too deeply") != std::string::npos);
+    CHECK(!m.add("x", std::string(30000, '-') + "a", &err) && err.find("nested too deeply") != std::string::npos);
+    CHECK(!m.add("x", "abs(" + std::string(30000, '(') + "a", &err) && err.find("nested too deeply") != std::string::npos);
+    CHECK(m.add("ok", std::string(20, '(') + "a" + std::string(20, ')'), &err));
+}
+
+int main() {
+    testEvaluate();
+    testErrors();
+    return reportChecks();
+}